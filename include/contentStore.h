@@ -0,0 +1,127 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                contentStore.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Content-addressed store of uploaded files.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_CONTENTSTORE_H
+#define WTEXTENSIONS_CONTENTSTORE_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// WtExtensions header files
+#include "include/threadPool.h"
+
+/* The store holds one copy (blob) of each uploaded file, named by the SHA-256 digest of its content. The blobs are also indexed by
+ * a fingerprint: the SHA-256 digest of the first block, the last block and the size (in decimal) of the file. The browser can
+ * compute the fingerprint cheaply, without reading the whole file, and only computes the SHA-256 digest of the whole file when
+ * the store may hold the content. A fingerprint does not cover the whole file, so content is only taken from the store by its
+ * SHA-256 digest.
+ *
+ * Files are hard linked into and out of the store, so no data is copied and each content is held once. Blobs are read only (by
+ * the owner), and a blob shares its inode with the file it was linked from and the files linked to it, so none of these can be
+ * changed in place. The store should be on the same file system as the spool files. A file on another file system is copied into
+ * the store on the store's worker thread, and its digest is verified as it is copied. Files are only linked out of the store to
+ * the same file system.
+ */
+
+class CContentStore
+{
+public:
+  static constexpr std::uint64_t blockSize = 65536;
+
+  /*! @brief      Constructor. Indexes the blobs in the directory.
+   *  @param[in]  directory: The directory holding the blobs. Created if it does not exist.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  explicit CContentStore(std::filesystem::path const &directory);
+  ~CContentStore() = default;
+
+  /*! @brief      Determines if the store may hold the content with a fingerprint.
+   *  @param[in]  fingerprint: The fingerprint of the content.
+   *  @returns    true if a blob has the fingerprint.
+   *  @throws
+   */
+  bool contains(std::string const &fingerprint) const;
+
+  /*! @brief      Computes the fingerprint of a file.
+   *  @param[in]  file: The file.
+   *  @returns    The fingerprint in hex. Empty if the file cannot be read.
+   *  @throws
+   */
+  static std::string fingerprint(std::filesystem::path const &file);
+
+  /*! @brief      Adds a file to the store. Nothing is done if the store already holds the content. The file is made read only.
+   *  @param[in]  file: The file.
+   *  @param[in]  sha256: The SHA-256 digest of the file in hex.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  void insert(std::filesystem::path const &file, std::string const &sha256);
+
+  /*! @brief      Links the blob with a SHA-256 digest to the destination.
+   *  @param[in]  sha256: The SHA-256 digest of the content in hex.
+   *  @param[in]  blobFingerprint: The fingerprint of the content.
+   *  @param[in]  destination: The path to link the blob to. Must not exist.
+   *  @returns    true if the blob was linked. false if the store does not hold the content, the fingerprint of the blob is
+   *              different, or the destination is on another file system.
+   *  @throws
+   */
+  bool link(std::string const &sha256, std::string const &blobFingerprint, std::filesystem::path const &destination);
+
+private:
+  CContentStore() = delete;
+  CContentStore(CContentStore const &) = delete;
+  CContentStore(CContentStore &&) = delete;
+  CContentStore &operator=(CContentStore const &) = delete;
+  CContentStore &operator=(CContentStore &&) = delete;
+
+  std::filesystem::path const directory;
+  std::map<std::string, std::string> byFingerprint;      // Fingerprint, SHA-256 digest.
+  mutable std::mutex mStore;                             // Held to read or update the index.
+  CThreadPool copyPool{1};                               // Destroyed first, so the copies complete.
+
+  /*! @brief      Copies a file on another file system into the store. Called on the worker thread.
+   *  @param[in]  file: The file.
+   *  @param[in]  sha256: The SHA-256 digest of the file in hex.
+   *  @throws     noexcept
+   */
+  void copyIn(std::filesystem::path const &file, std::string const &sha256) noexcept;
+
+  /*! @brief      Adds a blob to the index.
+   *  @param[in]  sha256: The SHA-256 digest of the blob in hex.
+   *  @throws
+   */
+  void index(std::string const &sha256);
+};
+
+#endif // WTEXTENSIONS_CONTENTSTORE_H
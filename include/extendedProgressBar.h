@@ -31,12 +31,29 @@
 #ifndef WTEXTENSIONS_INCLUDE_EXTENDEDPROGRESSBAR_H_
 #define WTEXTENSIONS_INCLUDE_EXTENDEDPROGRESSBAR_H_
 
+// Standard C++ library
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
 // Wt++ library
 
 #include <Wt/WApplication.h>
 #include <Wt/WProgressBar.h>
 
-class extendedProgressBar : public Wt::WProgressBar
+// WtExtensions header files
+
+#include "include/pullMode.h"
+
+/* setValue() and setRange() store the new values in atomics and can be called from any thread.
+ * In push mode (the default) the first change after the values were last applied posts an update to the application's mailbox.
+ * Further changes before the mailbox is drained only overwrite the stored values.
+ * In pull mode (setPullMode()) nothing is posted. A timer in the browser requests the changes at the pull interval and the
+ * values are applied in the GUI thread. In neither mode do worker threads take the update lock.
+ */
+
+class extendedProgressBar : public Wt::WProgressBar, public CPullMode
 {
 public:
   extendedProgressBar(Wt::WApplication &);
@@ -53,6 +70,15 @@ private:
   extendedProgressBar &operator=(extendedProgressBar &&) = delete;
 
   Wt::WApplication *app = nullptr;
+  std::atomic<bool> valueChanged = false;
+  std::atomic<bool> rangeChanged = false;
+  std::atomic<double> pendingValue = 0;
+  std::atomic<double> pendingMinimum = 0;
+  std::atomic<double> pendingMaximum = 100;
+
+  /*! @brief      Applies the stored values. Called from the GUI thread.
+   */
+  virtual void applyPending() override;
 };
 
 
@@ -35,6 +35,8 @@
 // Standard C++ library
 #include <cstdint>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 // Wt Library
 
@@ -46,6 +48,8 @@
  * This is implemented as a container with a MVC table view holding the information.
  * The icon needs to be supplied and be part of the resource pack.
  * A signal is emitted when the delete button is pressed.
+ * The model is only created, and the view set up, when the widget is first rendered. Files inserted before then are held in a
+ * list and loaded into the model when it is created.
  */
 
 class CFileListWidget : public Wt::WTableView
@@ -61,6 +65,12 @@ public:
 
   void erase(std::filesystem::path const &);
 
+protected:
+  /*! @brief      Creates the UI on the first render.
+   *  @param[in]  flags: The render flags.
+   */
+  virtual void render(Wt::WFlags<Wt::RenderFlag> flags) override;
+
 private:
   CFileListWidget(CFileListWidget const &) = delete;
   CFileListWidget(CFileListWidget &&) = delete;
@@ -69,6 +79,14 @@ private:
 
   std::shared_ptr<Wt::WAbstractItemModel> model;
 
+  struct pendingRecord_t
+  {
+    ID_t ID;
+    std::filesystem::path fileName;
+    std::string fileType;
+  };
+  std::vector<pendingRecord_t> pendingRecords;        // Files inserted before the model is created.
+
   void createUI();
 };
 
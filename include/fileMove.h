@@ -0,0 +1,54 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                fileMove.h
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Moves files to their destination without copying where possible.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_FILEMOVE_H
+#define WTEXTENSIONS_FILEMOVE_H
+
+// Standard C++ header files
+#include <filesystem>
+
+/* A file on the same file system as the destination is renamed, which only changes the directory entries, however large the file.
+ * A file on another file system is copied in the kernel with copy_file_range(), or sendfile() if that is not supported, so the
+ * data is not copied through user space. The copy is written to an unnamed file (O_TMPFILE) in the destination directory and
+ * linked to the destination when it is complete, so the destination never holds a partial file. If the file system does not
+ * support O_TMPFILE, a temporary name in the destination directory is used instead.
+ *
+ * Uploads can be moved without copying by placing the Wt spool directory on the same file system as the destination.
+ */
+
+/*! @brief      Moves a file. An existing destination is replaced.
+ *  @param[in]  source: The file to move.
+ *  @param[in]  destination: The destination path.
+ *  @param[in]  tmpFile: true to write copies to an unnamed file (O_TMPFILE) that is linked when complete.
+ *  @throws     std::filesystem::filesystem_error
+ */
+void moveFile(std::filesystem::path const &source, std::filesystem::path const &destination, bool tmpFile = true);
+
+#endif // WTEXTENSIONS_FILEMOVE_H
@@ -0,0 +1,54 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                fileTypeSniffer.h
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Determines the type of a file from its first bytes.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_FILETYPESNIFFER_H
+#define WTEXTENSIONS_FILETYPESNIFFER_H
+
+// Standard C++ header files
+#include <filesystem>
+#include <string>
+
+/* The sniffer reads the first 4kB of the file with a single pread() and compares it with a table of signatures ("magic bytes").
+ * The signatures are grouped by their first byte, so only the signatures that start with the file's first byte are compared.
+ * ZIP files are further classified as XLSX, DOCX, PPTX or OpenDocument files by the names in the first entries. Files without
+ * a signature are classified as CSV, TSV or text if the data is text.
+ *
+ * The function has the signature of CFileUploadWidget::fileType_f and is the default for CFileUploadWidget::fileTypeDetection().
+ */
+
+/*! @brief      Determines the type of a file.
+ *  @param[in]  file: The file to classify.
+ *  @param[in]  clientFileName: The client file name. (Not used)
+ *  @returns    The type of the file. "Unknown" if the type could not be determined.
+ *  @throws
+ */
+std::string sniffFileType(std::filesystem::path const &file, std::filesystem::path const &clientFileName);
+
+#endif // WTEXTENSIONS_FILETYPESNIFFER_H
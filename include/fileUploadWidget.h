@@ -33,20 +33,43 @@
 
 // Standard C++ library header files
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <semaphore>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // Wt++ header files
 #include <Wt/WFileDropWidget.h>
+#include <Wt/WJavaScript.h>
 #include <Wt/WSignal.h>
 
+// WtExtensions header files
+#include "include/contentStore.h"
+#include "include/fileMove.h"
+#include "include/fileTypeSniffer.h"
+#include "include/mappedUpload.h"
+#include "include/pullMode.h"
+#include "include/spoolReader.h"
+#include "include/streamInflater.h"
+#include "include/threadPool.h"
+#include "include/uploadConsumer.h"
+#include "include/uploadDigest.h"
+#include "include/uploadGovernor.h"
+#include "include/uploadResumeStore.h"
+
 class CFileListModel;
 
 /*! @class    CFileUploadWidget is an extension of WFileDropWidget. It functions as a file drop area. But when the files are dropped
@@ -56,9 +79,65 @@ class CFileListModel;
  *            The application can then determine the file type and display the file type in the space vacated by the progress
  *            bar.
  *            Three columns are provided, with the third column allowing a delete button to delete the file from the upload list.
+ *            The model is created with the widget, as it keeps the record bookkeeping. The table view and delegate are only
+ *            created when the widget is first rendered.
+ *
+ *            Chunked uploads: When a chunk size is set, the files are passed through a JavaScript filter pipeline in the
+ *            browser (WFileDropWidget::setJavaScriptFilter()) and sent in chunks of that size. Stages can be added to the pipeline
+ *            with addFilterStage(). A stage is a JavaScript function (context, data) that returns the transformed data (a
+ *            Uint8Array) or a Promise of it. The context holds the browser File (file), the offset of the chunk in the file
+ *            (offset) and whether it is the last chunk (last).
+ *
+ *            Resumable uploads: When a resume store is also set, the whole chunks received by an upload that fails, or that is
+ *            still in flight when the widget is destroyed, are saved in the store. When the same file (name, size and modification
+ *            time) is dropped again, the pipeline skips the chunks the store already holds and, when the upload completes, the
+ *            held part is joined with the remainder in the file's spool file. The application sees the whole file.
+ *
+ *            Compressed uploads: When compression is enabled, the last stage of the pipeline gzip compresses each chunk in the
+ *            browser (CompressionStream). The server decompresses the spool file as the chunks arrive and, when the upload
+ *            completes, replaces the spool file with the decompressed data. Progress is reported against the original size.
+ *            Browsers without CompressionStream send the chunks uncompressed and the spool file is kept. Compressed uploads are
+ *            not resumed.
+ *
+ *            Digests: When digests are set, they are computed as the data is received, from the data appended to the spool file
+ *            (after decompression for compressed uploads). They are available in the record (digests) and through digest() when
+ *            the upload completes, so the file does not need to be read again. Resumed uploads, and files the browser did not
+ *            compress, are digested from the spool file on completion.
+ *
+ *            Deduplication: When a content store is set, the browser computes the fingerprint of each dropped file
+ *            (CContentStore::fingerprint()) and sends it to the server. If the store may hold the content, the browser is asked
+ *            for the SHA-256 digest of the whole file, and if the store holds that content, the blob is linked to a file owned
+ *            by the widget (in the spool directory), the upload is cancelled and fileLinked() is emitted with the path of the
+ *            file. Files that are uploaded are linked into the store and become read only. If the digest arrives after the
+ *            upload has completed, the upload is used. Fingerprints require a secure context (https) in the browser.
+ *
+ *            Type detection: The file type function (by default the magic byte sniffer, sniffFileType()) is called for each
+ *            completed file on a worker pool, so the files are classified in parallel and the GUI thread is not blocked. The
+ *            results are stored in the record (fileType and completedText) and displayed. Results that arrive together are
+ *            applied in one update through the mailbox. (See fileTypeDetection())
+ *
+ *            Streaming: Consumers added with addConsumer() receive the data of each file as it is received, so the file can be
+ *            processed while it is still uploading. (See CUploadConsumer)
+ *
+ *            Processing: When a processing function is set, the completed files are queued to be processed by a number of
+ *            worker threads, so the next file uploads while the previous ones are processed. The status column shows that the
+ *            file is queued, then processing, then the text returned by the function. When the queue is full, the uploads are
+ *            paused until a file has been processed. Uploads are paused before the next file starts in the browser, which
+ *            requires a chunk size to be set. Without a chunk size only further drops are refused, and the files already
+ *            dropped wait in the queue.
+ *
+ *            Moving: moveUpload() moves a completed file to its destination with a rename rather than a copy. (See moveFile())
+ *
+ *            Mapping: mapUpload() returns a read-only memory mapped view of a completed file, so it can be parsed without being
+ *            copied into buffers. (See CMappedUpload)
+ *
+ *            Admission: When an upload governor is set, the size of each dropped file is reserved against the server's budget
+ *            and the session's quota before the file is sent. A file that does not fit waits, with its status showing that it is
+ *            waiting, until the governor admits it. Holding the file in the browser requires a chunk size to be set. Without
+ *            a chunk size, and for files larger than the budget or the quota, the upload is refused before it starts.
  */
 
-class CFileUploadWidget : public Wt::WFileDropWidget
+class CFileUploadWidget : public Wt::WFileDropWidget, public CPullMode
 {
 public:
   using mutex_type = std::shared_mutex;
@@ -71,7 +150,17 @@ public:
     S_UPLOADING,    // The file is uploading.
     S_COMPLETE,     // The action is complete. The finalText is displayed.
   };
+  enum processStatus_e
+  {
+    P_NONE,         // The file is not processed.
+    P_QUEUED,       // The file is waiting for a processing thread.
+    P_PROCESSING,   // The file is being processed.
+    P_PROCESSED,    // The file has been processed. The text returned by the processing function is displayed.
+    P_FAILED,       // The processing function threw. The exception is displayed.
+    P_CANCELLED,    // The widget was destroyed before the file was processed.
+  };
   using ID_t = std::uint32_t;
+  static_assert(std::is_same_v<ID_t, CUploadConsumer::ID_t>);
   using row_t = std::size_t;
   struct record_t
   {
@@ -86,8 +175,24 @@ public:
     std::atomic_flag recordUpdated;
     Wt::Signals::connection dataReceivedConnection;
     Wt::Signals::connection uploadCompleteConnection;
-    mutex_type mRecord;
+    mutable mutex_type mRecord;
     std::string completedText = "Upload Completed";
+    std::string fileKey;                              // Identifies the file. (CUploadResumeStore::key())
+    std::string resumeKey;                            // Key of the file in the resume store.
+    std::uint64_t resumeOffset = 0;                   // Bytes held by the resume store when the file was dropped.
+    bool compressed = false;                          // The file is compressed by the browser.
+    std::uint64_t bytesReceived = 0;                  // Bytes read from the spool file. (Compressed, if compressed.)
+    std::uint64_t bytesInflated = 0;                  // Bytes decompressed from the data received.
+    std::unique_ptr<CSpoolReader> spoolReader;
+    std::unique_ptr<CStreamInflater> inflater;
+    std::unique_ptr<CUploadDigest> digest;
+    CUploadDigest::digests_t digests;                 // Hex digests of the file. Set when the upload completes.
+    std::filesystem::path linkedFile;                 // The file linked from the content store if the upload was skipped.
+    std::filesystem::path movedFile;                  // The destination the file was moved to. (moveUpload())
+    bool streaming = false;                           // The consumers have been sent begin() and not end().
+    processStatus_e processStatus = P_NONE;
+    std::string pendingText = "Pending";              // Displayed until the upload starts.
+    CUploadGovernor::ticket_t admissionTicket = 0;    // The reservation in the upload governor.
   };
   using value_type = record_t;
   using reference = value_type &;
@@ -102,16 +207,28 @@ public:
   // Callback function allowing the application to set the type text for the uploaded file.
   typedef std::string (*fileType_f)(std::filesystem::path const &, std::filesystem::path const &);
 
+  // Function called to process a completed file. Called with the file's ID, the path of the file and the client file name.
+  // Returns the text to display for the file.
+  using process_f = std::function<std::string(ID_t, std::filesystem::path const &, std::filesystem::path const &)>;
+
   struct fileData_t
   {
-    mutex_type mData;                                 // To read or update any of the fields in data this mutex must be held.
+    mutable mutex_type mData;                         // To read or update any of the fields in data this mutex must be held.
     value_list files;
     std::atomic_flag filesUpdated;
     value_list records;     // All the records.
     std::map<ID_t, value_ref> byID;
     std::map<Wt::WFileDropWidget::File *, value_ref> byPointer;
     std::vector<value_ref> byRow;
-    Wt::WFileDropWidget::File *currentFile = nullptr;
+    std::size_t uploadsInFlight = 0;                  // Files that have started and not finished uploading.
+    std::uint64_t chunkSize = 0;                      // Zero if uploads are not chunked.
+    bool compression = false;
+    std::vector<std::string> digestNames;
+    std::vector<std::shared_ptr<CUploadConsumer>> consumers;
+    std::shared_ptr<CContentStore> contentStore;
+    std::function<void(reference)> uploadCompleted;  // Called by the model when an upload has completed.
+    std::shared_ptr<CUploadResumeStore> resumeStore;
+    std::filesystem::path spoolDirectory;             // Directory of the files linked from the content store.
     ID_t lastID = 0;
     std::atomic_flag progressUpdate;
   };
@@ -120,7 +237,66 @@ public:
    *  @throws
    */
   CFileUploadWidget(Wt::WApplication &a);
-  virtual ~CFileUploadWidget() = default;
+
+  /*! @brief      Destructor. Uploads that are in flight are saved in the resume store.
+   */
+  virtual ~CFileUploadWidget();
+
+  /*! @brief      Adds a consumer that receives the data of the files as they are received. Must be added before files are
+   *              dropped.
+   *  @param[in]  consumer: The consumer.
+   *  @throws     RUNTIME_ASSERT
+   */
+  void addConsumer(std::shared_ptr<CUploadConsumer> consumer);
+
+  /*! @brief      Adds a stage to the end of the JavaScript filter pipeline. Only applies when a chunk size is set.
+   *  @param[in]  stage: The JavaScript function implementing the stage.
+   *  @throws
+   */
+  void addFilterStage(std::string const &stage);
+
+  /*! @brief      Sets the chunk size for uploads. Must be set before files are dropped.
+   *  @param[in]  cs: The chunk size in bytes. (0 = uploads are not chunked)
+   *  @throws
+   */
+  void chunkSize(std::uint64_t cs);
+
+  /*! @brief      Enables compression of uploads in the browser. Requires a chunk size to be set. Must be set before files are
+   *              dropped.
+   *  @param[in]  enable: true to compress uploads.
+   *  @throws
+   */
+  void compression(bool enable);
+
+  /*! @brief      Sets the content store used to skip the upload of files the server already holds. SHA256 is added to the digests.
+   *              Must be set before files are dropped.
+   *  @param[in]  cs: The content store. (nullptr = uploads are not deduplicated)
+   *  @throws
+   */
+  void contentStore(std::shared_ptr<CContentStore> cs);
+
+  /*! @brief      Sets the function used to determine the type of the completed files. The function is called on the worker pool
+   *              with the path of the file and the client file name, and must be thread safe. Must be set before files are
+   *              dropped.
+   *  @param[in]  ft: The file type function. (Default is the magic byte sniffer, nullptr = types are not detected)
+   *  @param[in]  pool: The worker pool. (nullptr = a pool of two threads shared by all the widgets)
+   *  @throws
+   */
+  void fileTypeDetection(fileType_f ft = sniffFileType, std::shared_ptr<CThreadPool> pool = nullptr);
+
+  /*! @brief      Returns a digest of an uploaded file.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  digestName: The digest.
+   *  @returns    The hex digest. Empty if the upload has not completed or the digest was not computed.
+   *  @throws     CODE_ERROR if the file does not exist.
+   */
+  std::string digest(ID_t fileID, std::string const &digestName) const;
+
+  /*! @brief      Sets the digests to compute as files are received. Must be set before files are dropped.
+   *  @param[in]  dn: The digest names (OpenSSL names, eg "SHA256").
+   *  @throws
+   */
+  void digests(std::vector<std::string> const &dn);
 
   /*! @brief      Clears all the data. All the files should also be deleted.
    *  @throws     nothrow
@@ -129,19 +305,83 @@ public:
 
   void erase(std::filesystem::path const &);
 
+  /*! @brief      Signal emitted when a file has been linked from the content store rather than uploaded. The file is read only.
+   *  @returns    The signal. The arguments are the file's ID and the path of the linked file.
+   */
+  Wt::Signal<ID_t, std::filesystem::path> &fileLinked() noexcept { return fileLinkedSignal; }
+
+  /*! @brief      Maps a completed file into memory. The view remains valid if the file is later removed or moved.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  advice: How the data will be read.
+   *  @returns    The mapped view of the file.
+   *  @throws     CODE_ERROR if the file does not exist.
+   *  @throws     RUNTIME_ASSERT if the upload has not completed.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  CMappedUpload mapUpload(ID_t fileID, CMappedUpload::advice_e advice = CMappedUpload::A_SEQUENTIAL) const;
+
   /*! @brief      Sets the maximum number of files that can be uploaded by the widget.
    *  @param[in]  mf: The maximum number of files.
    *  @throws     noexcept
    */
   void maxFiles(std::size_t mf) noexcept { maxFiles_ = mf;}
 
-  /*! @brief      Sets the file's completed text.
+  /*! @brief      Sets the function used to process the completed files. The function is called on the processing threads and
+   *              must be thread safe. Exceptions thrown by the function are displayed as the file's text. Must be set before
+   *              files are dropped.
+   *  @param[in]  pf: The processing function. (nullptr = files are not processed)
+   *  @param[in]  workers: The number of processing threads.
+   *  @param[in]  queueLimit: The number of files that may be queued or processing before the uploads are paused.
+   *  @throws     RUNTIME_ASSERT
+   */
+  void processing(process_f pf, std::size_t workers = 1, std::size_t queueLimit = 4);
+
+  /*! @brief      Sets the store used to resume interrupted uploads. Resuming requires a chunk size to be set.
+   *  @param[in]  rs: The resume store. (nullptr = uploads are not resumed)
+   *  @throws
+   */
+  void resumeStore(std::shared_ptr<CUploadResumeStore> rs);
+
+  /*! @brief      Sets the directory that the files linked from the content store are created in. It must be on the same file
+   *              system as the content store, and should be on the same file system as the destinations of moveUpload(), so
+   *              that the files are renamed rather than copied.
+   *  @param[in]  directory: The directory. (Default is the directory of Wt's spool files.)
+   *  @throws
+   */
+  void spoolDirectory(std::filesystem::path const &directory);
+
+  /*! @brief      Moves a completed file to a destination. The file is then owned by the application and is not removed by the
+   *              widget. The file should not be moved while it is being processed.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  destination: The destination path. An existing file is replaced.
+   *  @param[in]  tmpFile: true to write a copy to another file system to an unnamed file that is linked when complete.
+   *  @throws     CODE_ERROR if the file does not exist.
+   *  @throws     RUNTIME_ASSERT if the upload has not completed, or the file is being processed.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  void moveUpload(ID_t fileID, std::filesystem::path const &destination, bool tmpFile = true);
+
+  /*! @brief      Sets the governor that admits the uploads. Must be set before files are dropped.
+   *  @param[in]  ug: The upload governor shared by the sessions. (nullptr = uploads are not governed)
+   *  @throws
+   */
+  void uploadGovernor(std::shared_ptr<CUploadGovernor> ug) { governor = std::move(ug); }
+
+  /*! @brief      Returns the number of files that have started and not finished uploading. Called from the GUI thread.
+   *  @details    Each file is tracked independently, so the table supports any number of files in flight. The Wt drop widget
+   *              transport requests one file at a time, so with that transport this is at most one.
+   *  @returns    The number of files in flight.
+   */
+  std::size_t uploadsInFlight() const noexcept { return fileData.uploadsInFlight; }
+
+  /*! @brief      Sets the file's completed text. May be called from any thread.
    *  @param[in]  fileID: the file's ID.
    *  @param[in]  ct: completedText
    *  @throws
    */
   void setCompletedText(ID_t fileID, std::string const &ct);
 
+
 protected:
   Wt::WTableView *tableView = nullptr;
   std::shared_ptr<CFileListModel> model;
@@ -152,6 +392,11 @@ protected:
    */
   virtual void createUI();
 
+  /*! @brief      Creates the UI on the first render.
+   *  @param[in]  flags: The render flags.
+   */
+  virtual void render(Wt::WFlags<Wt::RenderFlag> flags) override;
+
   /*! @brief      Returns the maximum number of files that can be uploaded.
    *  @returns    The maximum number of files.
    */
@@ -178,6 +423,138 @@ private:
   fileData_t fileData;
   std::uint16_t maxFiles_ = 50;
   Wt::Signal<ID_t, Wt::WFileDropWidget::File *> fileUploadSignal;
+  Wt::Signal<ID_t, std::filesystem::path> fileLinkedSignal;
+  Wt::JSignal<std::string, std::string> fingerprintSignal;
+  Wt::JSignal<std::string, std::string> contentDigestSignal;
+  Wt::JSignal<std::string> dropKeysSignal;
+  std::deque<std::pair<std::uint64_t, std::uint64_t>> droppedModified;   // Size and modification time of the dropped files.
+  std::mutex mPending;
+  std::vector<std::pair<ID_t, std::string>> pendingCompletedText;
+  std::vector<std::string> filterStages;
+  std::map<std::string, std::uint64_t> resumeOffsets;   // Offsets of the dropped files that resume.
+  std::map<std::string, std::string> offeredFingerprints;  // Keys of the files whose digest was requested, and their fingerprints.
+  fileType_f fileTypeFunction = sniffFileType;
+  std::shared_ptr<CThreadPool> typePool;            // nullptr until the first type is detected.
+
+  /* The detected types are written by the pool threads. The pool may be shared and outlive the widget, so the destructor cancels
+   * the jobs that have not started and waits for the jobs that are running.
+   */
+
+  struct detectedTypes_t
+  {
+    std::mutex mTypes;
+    std::vector<std::pair<ID_t, std::string>> types;
+    bool cancelled = false;
+    std::size_t running = 0;                          // Jobs that are detecting a type.
+    std::condition_variable cvRunning;
+  };
+  std::shared_ptr<detectedTypes_t> detectedTypes = std::make_shared<detectedTypes_t>();
+
+  // The processing status changes are written by the processing threads and applied in the GUI thread.
+
+  struct processingStatus_t
+  {
+    std::mutex mStatus;
+    std::vector<std::tuple<ID_t, processStatus_e, std::string>> changes;
+    std::size_t queued = 0;                           // Files submitted that have not reached a terminal state.
+    bool cancelled = false;                           // Files that have not started processing are cancelled.
+  };
+  std::shared_ptr<processingStatus_t> processingStatus = std::make_shared<processingStatus_t>();
+  process_f processFunction;
+  std::size_t processQueueLimit = 4;
+  bool uploadsPaused = false;
+
+  // The pool is destroyed before the base class removes the spool files, so the processing completes first.
+
+  std::unique_ptr<CThreadPool> processPool;
+  std::shared_ptr<CUploadGovernor> governor;
+
+  /*! @brief      Submits a completed file to the worker pool for type detection.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  filePath: The path of the file.
+   *  @param[in]  clientFileName: The client file name.
+   *  @throws
+   */
+  void detectFileType(ID_t fileID, std::filesystem::path const &filePath, std::filesystem::path const &clientFileName);
+
+  /*! @brief      Allows the browser to send files.
+   *  @param[in]  keys: The keys of the files. (CUploadResumeStore::key())
+   */
+  void admitFiles(std::vector<std::string> const &keys);
+
+  /*! @brief      Called in the GUI thread when the governor admits a file that was waiting.
+   *  @param[in]  ticket: The ticket of the file.
+   */
+  void fileAdmitted(CUploadGovernor::ticket_t ticket);
+
+  /*! @brief      Releases the file's reservation in the upload governor.
+   *  @param[in]  record: The record of the file.
+   */
+  void releaseAdmission(reference record);
+
+  /*! @brief      Returns a JavaScript expression for the gate that pauses the uploads in the filter pipeline.
+   *  @returns    The JavaScript expression.
+   */
+  std::string gateRef() const;
+
+  /*! @brief      Pauses or resumes the uploads.
+   *  @param[in]  pause: true to pause the uploads.
+   */
+  void pauseUploads(bool pause);
+
+  /*! @brief      Pauses the uploads if the processing queue is full, and resumes them if it is not.
+   */
+  void updatePause();
+
+  /*! @brief      Returns the path of a completed file.
+   *  @param[in]  record: The record of the file.
+   *  @returns    The moved file, the linked file or the spool file.
+   */
+  std::filesystem::path uploadPath(const_reference record) const;
+
+  /*! @brief      Submits a completed file to the processing threads.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  filePath: The path of the file.
+   *  @param[in]  clientFileName: The client file name.
+   *  @throws
+   */
+  void processFile(ID_t fileID, std::filesystem::path const &filePath, std::filesystem::path const &clientFileName);
+
+  /*! @brief      Links a dropped file from the content store if the digest was requested and the store holds its content.
+   *  @param[in]  key: The key of the file. (CUploadResumeStore::key())
+   *  @param[in]  sha256: The SHA-256 digest of the whole file computed by the browser.
+   */
+  void contentDigestReceived(std::string key, std::string sha256);
+
+  /*! @brief      Discards the partly decompressed data of a compressed upload that did not complete.
+   *  @param[in]  record: The record of the file.
+   */
+  void discardInflater(reference record);
+
+  /*! @brief      Records the size and modification time of each dropped file. Sent by the browser before the drop.
+   *  @param[in]  keys: "<size>:<lastModified>" for each file, in drop order, separated by commas.
+   */
+  void dropKeysReceived(std::string keys);
+
+  /*! @brief      Asks the browser for the SHA-256 digest of a dropped file if the store may hold its content.
+   *  @param[in]  key: The key of the file. (CUploadResumeStore::key())
+   *  @param[in]  fingerprint: The fingerprint computed by the browser.
+   */
+  void fingerprintReceived(std::string key, std::string fingerprint);
+
+  /*! @brief      Saves the received chunks of a file that failed to upload in the resume store.
+   *  @param[in]  file: The file.
+   */
+  void fileUploadFailed(Wt::WFileDropWidget::File *file);
+
+  /*! @brief      Sends the JavaScript filter pipeline to the browser.
+   *  @throws
+   */
+  void updateFilter();
+
+  /*! @brief      Applies the queued changes. Called from the GUI thread.
+   */
+  virtual void applyPending() override;
 };
 
 
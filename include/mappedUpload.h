@@ -0,0 +1,92 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                mappedUpload.h
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Read-only memory mapped view of a completed upload.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_MAPPEDUPLOAD_H
+#define WTEXTENSIONS_MAPPEDUPLOAD_H
+
+// Standard C++ header files
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+/* The file is mapped read-only (mmap()), so a parser reads the data directly from the page cache rather than copying it into a
+ * buffer. The advice (madvise()) tells the kernel how the data will be read. Sequential advice reads ahead aggressively and
+ * frees the pages behind the reader. Will-need advice starts reading the whole file into the page cache immediately.
+ *
+ * The mapping remains valid if the file is removed or renamed. The file must not be truncated while it is mapped. An empty file
+ * is not mapped and has an empty view.
+ */
+
+class CMappedUpload
+{
+public:
+  enum advice_e
+  {
+    A_NORMAL,       // No advice.
+    A_SEQUENTIAL,   // The data is read in order. (MADV_SEQUENTIAL)
+    A_WILLNEED,     // The whole file will be read soon. (MADV_WILLNEED)
+    A_RANDOM,       // The data is read in random order. (MADV_RANDOM)
+  };
+
+  /*! @brief      Constructor. Maps the file.
+   *  @param[in]  file: The file to map.
+   *  @param[in]  advice: How the data will be read.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  explicit CMappedUpload(std::filesystem::path const &file, advice_e advice = A_SEQUENTIAL);
+
+  /*! @brief      Destructor. Unmaps the file.
+   */
+  ~CMappedUpload();
+
+  /*! @brief      Returns the data of the file.
+   *  @returns    The data.
+   *  @throws     noexcept
+   */
+  std::span<char const> data() const noexcept { return {address, size_}; }
+
+  /*! @brief      Returns the size of the file.
+   *  @returns    The size in bytes.
+   *  @throws     noexcept
+   */
+  std::size_t size() const noexcept { return size_; }
+
+private:
+  CMappedUpload() = delete;
+  CMappedUpload(CMappedUpload const &) = delete;
+  CMappedUpload(CMappedUpload &&) = delete;
+  CMappedUpload &operator=(CMappedUpload const &) = delete;
+  CMappedUpload &operator=(CMappedUpload &&) = delete;
+
+  char const *address = nullptr;
+  std::size_t size_ = 0;
+};
+
+#endif // WTEXTENSIONS_MAPPEDUPLOAD_H
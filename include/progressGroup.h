@@ -34,15 +34,23 @@
 // Standard C++ header files
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <forward_list>
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <ostream>
 #include <semaphore>
+#include <stop_token>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <variant>
+#include <vector>
 
 // Wt Library
 #include <Wt/WContainerWidget.h>
@@ -51,6 +59,9 @@
 // Miscellaneous library header files
 #include <SCL>
 
+// WtExtensions header files
+#include "include/updateMailbox.h"
+
 /* A progress groups is a container (maybe a tree or table) widget that has a list of progress items. Each item has a string
  * attached and a progress bar or text string. A tableview is closer packed than a table. However the tableview requires a
  * model to support data retrieval.
@@ -79,9 +90,17 @@
  * Step order is order of initialisation.
  * This approach allows a calling application to set up all the steps. Successive library calls can move to the next step and
  * update progress without knowing what steps they are on.
+ *
+ * The group's update thread runs once per update period while anything has changed. It merges the attached segments, rolls the
+ * progress and the estimates up the tree, publishes the snapshot and posts a refresh of the model to the application's mailbox.
+ *
+ * The model and tree view are only created when the group is first rendered. Groups in hidden tabs that are never opened do not
+ * create them. The actions are held in the data, so the steps can be set up and updated before the group is rendered.
  */
 
 class CProgressGroupModel;
+class CProgressJournal;
+class CProgressSegment;
 
 class CProgressGroup : public Wt::WContainerWidget
 {
@@ -90,12 +109,14 @@ class CProgressGroup : public Wt::WContainerWidget
     using actionID_t = std::uint32_t;
 
     using ID_t = std::uint64_t;
+    using clock_type = std::chrono::steady_clock;
     using mutex_type = std::shared_mutex;
     using unique_lock = std::unique_lock<mutex_type>;
     using shared_lock = std::shared_lock<mutex_type>;
     using uAdd_t = std::tuple<actionID_t, actionID_t, std::string>;
     using uProgress_t = double_t;
     using updateVariant_t = std::variant<std::monostate, uAdd_t, uProgress_t>;
+    using progressSample_t = std::pair<clock_type::time_point, double>;
     enum status_e
     {
       S_NONE,         //
@@ -103,6 +124,7 @@ class CProgressGroup : public Wt::WContainerWidget
       S_ACTIVE,       // This is the active action. There should only be one active action. When active, the progress bar is
                       // displayed.
       S_COMPLETE,     // The action is complete. The finalText is displayed.
+      S_CANCELLED,    // The action was cancelled before it completed.
     };
     struct actionItem_t;
     using value_ref = std::reference_wrapper<actionItem_t>;
@@ -114,7 +136,7 @@ class CProgressGroup : public Wt::WContainerWidget
       ID_t const PID;                               // Application provided PID.
       ID_t sortOrder;                               // Used for ordering the list of children.
       std::string const itemText;                   // Application provided item text.
-      mutex_type mActionItem;
+      mutable mutex_type mActionItem;
 
       // Model created Data.
 
@@ -124,10 +146,31 @@ class CProgressGroup : public Wt::WContainerWidget
       Wt::WText *textEditStatus = nullptr;          // Active when status == Pending or complete.
       Wt::WProgressBar *progressBar = nullptr;      // Active when status == Active.
       std::atomic<double> progress{0};              // Progress measurement.
+      std::atomic<std::uint64_t> unitsDone{0};      // Work units completed. (Counter mode only)
+      std::atomic<std::uint64_t> unitsTotal{0};     // Total work units. Zero if the step is not in counter mode.
+      std::stop_source stopSource;                  // Requested to stop when the action is cancelled.
       std::atomic_flag updateRequired;
       std::atomic_flag recalcRequired;
       Wt::WModelIndex index;
 
+      // Instrumentation. Protected by mActionItem.
+
+      clock_type::time_point timeBegin;             // Monotonic time that beginStep() was called.
+      clock_type::time_point timeComplete;          // Monotonic time that completeStep() was called.
+      std::thread::id beginThread;                  // The thread that called beginStep().
+      std::chrono::nanoseconds cpuBegin{0};         // CPU time of the calling thread when beginStep() was called.
+      std::chrono::nanoseconds cpuTime{0};          // CPU time used by the calling thread between begin and complete.
+      std::uint64_t itemsDone = 0;                  // Last numerator passed to updateStep(num, denom).
+      std::vector<progressSample_t> progressSamples;  // Progress history. Only recorded when tracing is enabled.
+      clock_type::time_point lastCheckpoint;        // Time of the last journal progress checkpoint.
+
+      // Rate estimation. Written by the update thread only.
+
+      double rate = 0;                              // Smoothed rate of progress. (fraction/second)
+      double lastSampleProgress = 0;                // Progress at the last estimator sample.
+      clock_type::time_point lastSampleTime;        // Time of the last estimator sample.
+      std::atomic<double> etaSeconds{-1};           // Estimated time to completion. (< 0 if not known)
+
       template<int N> ID_t get() const noexcept
       {
         if constexpr (N == 0)
@@ -160,9 +203,10 @@ class CProgressGroup : public Wt::WContainerWidget
     struct data_t
     {
       mutex_type mModel;
-      mutex_type mData;                                 // To read or update any of the fields in data this mutex must be held.
+      mutable mutex_type mData;                         // To read or update any of the fields in data this mutex must be held.
       value_list actions;
       std::map<ID_t, value_ref> byID;
+      SCL::vector_sorted<value_ref> children;           // Ordered list of the top level actions. (PID == 0)
       std::atomic_flag recordsUpdated;
       std::string pendingText;
       std::string completeText;
@@ -170,26 +214,138 @@ class CProgressGroup : public Wt::WContainerWidget
       std::list<value_ref> preOrderTree;
     };
 
+    /* Timing information for a step. The CPU time is only valid if beginStep() and completeStep() were called from the same
+     * thread. If the step is still active, elapsed is measured to the current time.
+     * The timing of an action with children is rolled up. The CPU time and items done include all the descendants. An action
+     * that was not begun itself spans from the first descendant begun to the last descendant completed.
+     */
+    struct stepTiming_t
+    {
+      status_e status;
+      clock_type::time_point timeBegin;
+      clock_type::time_point timeComplete;
+      clock_type::duration elapsed;
+      std::chrono::nanoseconds cpuTime;
+      std::uint64_t itemsDone;
+      double itemsPerSecond;
+    };
+
+    /* A snapshot is an immutable copy of the state of all the actions. Each item records the snapshot version in which it last
+     * changed, so that the changes since any earlier version can be extracted from the latest snapshot.
+     */
+    struct snapshotItem_t
+    {
+      ID_t ID;
+      ID_t PID;
+      std::string text;
+      status_e status;
+      double progress;
+      double etaSeconds;                          // < 0 if not known.
+      std::uint64_t version;                      // Snapshot version in which the item last changed.
+    };
+
+    struct snapshot_t
+    {
+      std::uint64_t epoch;                        // Random per group. Versions are only comparable within an epoch.
+      std::uint64_t version;
+      std::uint64_t changeCount;                  // The group's change count when the snapshot was taken.
+      clock_type::time_point taken;
+      double overallETASeconds;
+      std::vector<snapshotItem_t> items;          // Ordered by ID.
+    };
+
     /*! @brief      Class constructor.
      *  @param[in]  application: The application that owns this instance.
      *  @param[in]  ps: The string to display for pending items.
      *  @param[in]  cs: The string to display for complete items.
      */
     CProgressGroup(Wt::WApplication &application, std::string const &ps, std::string const &cs);
-    ~CProgressGroup() = default;
 
-    /*! @brief      Begins a action step. Change the text to a progress bar.
+    /*! @brief      Destructor. Stops and joins the update thread.
+     */
+    virtual ~CProgressGroup();
+
+    /*! @brief      Attaches a journal. Step transitions and progress checkpoints are then recorded in the journal.
+     *  @details    If replay is true, the journal is first replayed into the group. Completed steps are marked as complete and
+     *              the last progress checkpoint of any other step is restored. (The step remains pending so that it is rerun.)
+     *              Records for actions that are not in the group are ignored, so the actions must be inserted first. The journal
+     *              should be attached before any steps are begun.
+     *  @param[in]  journal: The journal to attach.
+     *  @param[in]  replay: true to replay the journal into the group.
+     *  @throws
+     */
+    void attachJournal(std::shared_ptr<CProgressJournal> journal, bool replay = true);
+
+    /*! @brief      Attaches a shared memory progress segment. The update thread polls the segment and merges the progress reported
+     *              by other processes into the tree.
+     *  @param[in]  segment: The segment to attach.
+     *  @throws
+     */
+    void attachSegment(std::shared_ptr<CProgressSegment> segment);
+
+    /*! @brief      Begins a action step. Change the text to a progress bar. A cancelled step remains cancelled.
      *  @param[in]  actionID: The action to begin.
+     *  @param[in]  measureCPU: true to measure the CPU time of the calling thread until the step completes on the same thread.
+     *                          (See measureCPU())
      *  @throws
      */
-    void beginStep(ID_t actionID);
+    void beginStep(ID_t actionID, bool measureCPU = true);
+
+    /*! @brief      Cancels a step. The step's stop token is requested to stop and the status is set to cancelled. Completed steps
+     *              are not changed.
+     *  @param[in]  actionID: The action to cancel.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    void cancelStep(ID_t actionID);
+
+    /*! @brief      Cancels a step and all of its descendants.
+     *  @param[in]  actionID: The root of the subtree to cancel. (0 = cancel all the actions.)
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    void cancelSubtree(ID_t actionID);
+
+    /*! @brief      Returns the stop token of a step. Steps should poll the token and return early when stop is requested.
+     *  @param[in]  actionID: The action.
+     *  @returns    The stop token.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    std::stop_token stopToken(ID_t actionID) const;
 
     /*! @brief      Marks a step as completed. Does not move onto the next step. Changes the progress bar to a text edit.
+     *              A cancelled step remains cancelled. Completing a step that is already complete has no effect.
      *  @param[in]  actionID: The action to begin.
      *  @throws
      */
     void completeStep(ID_t actionID);
 
+    /*! @brief      Detaches a shared memory progress segment.
+     *  @param[in]  segment: The segment to detach.
+     *  @throws
+     */
+    void detachSegment(std::shared_ptr<CProgressSegment> const &segment);
+
+    /*! @brief      Enables or disables the recording of progress samples for trace export.
+     *  @param[in]  enable: true to record progress samples.
+     *  @throws     noexcept
+     */
+    void enableTrace(bool enable = true) noexcept { traceEnabled = enable; }
+
+    /*! @brief      Writes the run as Chrome trace-event JSON. (Loadable by chrome://tracing and Perfetto.)
+     *  @details    Each begun step is written as a complete slice. Top level actions are written as separate tracks, with their
+     *              children nested below them. If tracing is enabled, the progress of each step is written as a counter track.
+     *  @param[in]  os: The stream to write to.
+     *  @throws
+     */
+    void exportTrace(std::ostream &os) const;
+
+    /*! @brief      Writes a snapshot as compact JSON. The epoch is written as a hex string.
+     *  @param[in]  os: The stream to write to.
+     *  @param[in]  snapshot: The snapshot to write.
+     *  @param[in]  since: Only write the items that have changed after this version. (0 = write all the items)
+     *  @throws
+     */
+    static void exportSnapshot(std::ostream &os, snapshot_t const &snapshot, std::uint64_t since = 0);
+
     /*! @brief      Insert a range of actions.
      *  @param[in]  begin: The beginning of the range.
      *  @param[in]  end: The end of the range.
@@ -214,6 +370,71 @@ class CProgressGroup : public Wt::WContainerWidget
      */
     void insertAction(ID_t actionID, ID_t parentID, ID_t sortOrder, std::string const &actionText);
 
+    /*! @brief      Measures the CPU time of an active step from now on the calling thread, in place of any earlier measurement. For
+     *              steps that are begun on one thread and do their own work on another, eg a stage that runs after its children.
+     *  @param[in]  actionID: The action.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    void measureCPU(ID_t actionID);
+
+    /*! @brief      Returns the parent of an action.
+     *  @param[in]  actionID: The action.
+     *  @returns    The parent ID of the action. (0 = top level)
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    ID_t parentID(ID_t actionID) const;
+
+    /*! @brief      Returns the timing and throughput information for a step, rolled up over its descendants.
+     *  @param[in]  actionID: The action to return the timing for.
+     *  @returns    The timing information.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    stepTiming_t stepTiming(ID_t actionID) const;
+
+    /*! @brief      Returns the status of a step.
+     *  @param[in]  actionID: The action.
+     *  @returns    The status.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    status_e stepStatus(ID_t actionID) const;
+
+    /*! @brief      Returns the latest published snapshot of the group. The snapshot is published by the update thread. If the
+     *              group has changed since the snapshot was published, a new snapshot is published first. Repeated calls while
+     *              the group is unchanged return the same snapshot without locking the actions. While counters are active, the
+     *              snapshot is republished at most once per snapshotInterval.
+     *  @returns    The snapshot.
+     *  @throws
+     */
+    std::shared_ptr<snapshot_t const> snapshot() const;
+
+    /*! @brief      Places a step into counter mode by declaring the total number of work units. The completed units are reset.
+     *  @details    In counter mode, workers increment an integer counter (addStepUnits() or stepCounter()). The progress is derived
+     *              from the counter when the model or the snapshot reads it, and is rolled up the tree by the update thread. The
+     *              counter may be incremented from any number of threads.
+     *  @param[in]  actionID: The action to place in counter mode.
+     *  @param[in]  total: The total number of work units. (Must be non-zero)
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    void setStepUnits(ID_t actionID, std::uint64_t total);
+
+    /*! @brief      Adds completed work units to a step that is in counter mode.
+     *  @param[in]  actionID: The action to update.
+     *  @param[in]  units: The number of units completed.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    void addStepUnits(ID_t actionID, std::uint64_t units = 1)
+    {
+      stepCounter(actionID).fetch_add(units, std::memory_order_relaxed);
+    }
+
+    /*! @brief      Returns the work unit counter for a step. Workers can hold the reference and call fetch_add() directly, which
+     *              avoids the action lookup on every update. The reference is valid for the life of the group.
+     *  @param[in]  actionID: The action.
+     *  @returns    Reference to the counter.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    std::atomic<std::uint64_t> &stepCounter(ID_t actionID);
+
     /*! @brief      Callback function that can be caleld to update the progress group,
      *  @param[in]  actionID: The action to update.
      *  @param[in]  updateEvent: The update event.
@@ -231,11 +452,24 @@ class CProgressGroup : public Wt::WContainerWidget
 
     /*! @brief      Updates an action step.
      *  @param[in]  actionID: The action to begin.
-     *  @param[in]  per: The percentage complete.
+     *  @param[in]  per: The fraction complete. (0.0 - 1.0)
      *  @throws
      */
     void updateStep(ID_t actionID, double per);
 
+    /*! @brief      Returns the estimated time remaining for a step.
+     *  @param[in]  actionID: The action to return the estimate for.
+     *  @returns    The estimated time remaining. No value if the estimate is not yet available.
+     *  @throws     CODE_ERROR if the action does not exist.
+     */
+    std::optional<clock_type::duration> stepETA(ID_t actionID) const;
+
+    /*! @brief      Returns the estimated time remaining for all the actions in the group.
+     *  @returns    The estimated time remaining. No value if the estimate is not yet available.
+     *  @throws     noexcept
+     */
+    std::optional<clock_type::duration> overallETA() const noexcept;
+
   protected:
     std::shared_ptr<CProgressGroupModel> model;
     data_t data;
@@ -246,6 +480,11 @@ class CProgressGroup : public Wt::WContainerWidget
      */
     void createWidget();
 
+    /*! @brief      Creates the model and subwidgets on the first render.
+     *  @param[in]  flags: The render flags.
+     */
+    virtual void render(Wt::WFlags<Wt::RenderFlag> flags) override;
+
 
   private:
     CProgressGroup() = delete;
@@ -255,14 +494,53 @@ class CProgressGroup : public Wt::WContainerWidget
     CProgressGroup &operator=(CProgressGroup &&) = delete;
 
     Wt::WApplication &application;
-    std::atomic_flag terminateThread;
     std::atomic_flag updatesReceived;
-    std::binary_semaphore sUpdateRequired{0};
+    std::counting_semaphore<> sUpdateRequired{0};      // Released whenever an action changes.
+    std::atomic<std::size_t> activeCounters = 0;      // Number of active steps in counter mode. The update thread polls these.
+    std::vector<std::shared_ptr<CProgressSegment>> segments;
+    std::mutex mSegments;
+    std::atomic<std::size_t> attachedSegments = 0;    // The update thread polls while any segments are attached.
     std::uint16_t updatePeriod = 1;
+    std::shared_ptr<CProgressJournal> journal;
+    std::atomic<std::uint64_t> changeCount = 0;       // Incremented whenever an action changes.
+    mutable std::atomic<std::shared_ptr<snapshot_t const>> publishedSnapshot;
+    mutable std::mutex mSnapshot;                     // Serialises publishing.
+    std::uint64_t snapshotEpoch = 0;
+    static constexpr clock_type::duration snapshotInterval = std::chrono::milliseconds(250);
+    static constexpr clock_type::duration checkpointInterval = std::chrono::seconds(1);
+    std::atomic<bool> traceEnabled = false;
+    std::atomic<double> overallETASeconds{-1};
+    static constexpr double rateSmoothing = 0.3;      // EWMA weighting of the latest rate sample.
+    static constexpr clock_type::duration traceSampleInterval = std::chrono::milliseconds(10);
+    std::shared_ptr<CUpdateMailbox> mailbox;
+    std::function<void()> refreshModel;               // Posted to the mailbox by the update thread.
+    std::mutex mUpdateWait;
+    std::condition_variable_any cvUpdateWait;         // The update thread waits out the update period on this.
+
+    // Declared last, so the thread is started after, and stopped before, the members it uses.
+
+    std::jthread updateThread_;
 
     /*! @brief      The thread that is used to update the GUI periodically.
+     *  @param[in]  stopToken: Requested to stop by the destructor.
+     */
+    void updateThread(std::stop_token stopToken);
+
+    /*! @brief      Updates the rate estimators and rolls the ETA up the tree. Called from the update thread.
+     *  @throws
+     */
+    void updateEstimates();
+
+    /*! @brief      Merges the progress from the attached segments into the tree. Called from the update thread.
+     *  @throws
+     */
+    void pollSegments();
+
+    /*! @brief      Publishes a new snapshot if the group has changed since the last snapshot.
+     *  @returns    The latest snapshot.
+     *  @throws
      */
-    void updateThread();
+    std::shared_ptr<snapshot_t const> publishSnapshot() const;
 };
 
 #endif
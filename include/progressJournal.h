@@ -0,0 +1,160 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressJournal.h
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Append-only journal of progress group step transitions.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_PROGRESSJOURNAL_H
+#define WTEXTENSIONS_PROGRESSJOURNAL_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+
+/* The journal is a file of fixed size records that is mapped into memory (MAP_SHARED). Records are appended by copying them into
+ * the mapping, so appending does not need a system call except when the file is grown. The pages belong to the page cache, so the
+ * records survive the process being killed or the server being restarted. flush() must be called if the records must also
+ * survive the machine crashing.
+ *
+ * Each record carries a checksum. When the journal is opened, the records are read sequentially up to the first record that is
+ * empty or does not match its checksum. A record that was torn by a crash is therefore discarded, along with anything after it.
+ *
+ * The journal is attached to a CProgressGroup with attachJournal(). The group then records each step transition and a periodic
+ * progress checkpoint for each step.
+ */
+
+class CProgressJournal
+{
+public:
+  using ID_t = std::uint64_t;
+
+  enum recordType_e : std::uint32_t
+  {
+    JR_NONE,
+    JR_BEGIN,         // The step has begun.
+    JR_PROGRESS,      // Progress checkpoint. (value = fraction complete)
+    JR_COMPLETE,      // The step has completed.
+  };
+
+  struct record_t
+  {
+    recordType_e type;
+    std::uint32_t checksum;
+    ID_t ID;
+    double value;
+    std::int64_t time;        // Wall clock time of the record. (ns since the epoch)
+  };
+  static_assert(sizeof(record_t) == 32, "Journal records must be 32 bytes.");
+
+  using replay_f = std::function<void(record_t const &)>;
+
+  /*! @brief      Constructor. Opens the journal, creating it if it does not exist.
+   *  @param[in]  filePath: The journal file.
+   *  @throws     RUNTIME_ASSERT if the file cannot be opened or is not a journal.
+   */
+  explicit CProgressJournal(std::filesystem::path const &filePath);
+
+  /*! @brief      Destructor. Unmaps and closes the file. The file is not flushed.
+   */
+  ~CProgressJournal();
+
+  /*! @brief      Appends a record to the journal.
+   *  @param[in]  type: The record type.
+   *  @param[in]  actionID: The action.
+   *  @param[in]  value: The value of the record.
+   *  @throws     RUNTIME_ASSERT if the file cannot be grown.
+   */
+  void append(recordType_e type, ID_t actionID, double value = 0);
+
+  /*! @brief      Writes the journal to disk. Blocks until the write is complete.
+   *  @throws
+   */
+  void flush();
+
+  /*! @brief      Calls the function for each record in the journal, in the order that the records were appended.
+   *  @param[in]  replayFunction: The function to call.
+   *  @throws
+   */
+  void replay(replay_f const &replayFunction) const;
+
+  /*! @brief      Discards all the records. Used when a run has finished and the journal is no longer required.
+   *  @throws     RUNTIME_ASSERT if the file cannot be truncated.
+   */
+  void reset();
+
+  /*! @brief      Returns the number of records in the journal.
+   *  @returns    The number of records.
+   *  @throws
+   */
+  std::size_t size() const;
+
+private:
+  CProgressJournal() = delete;
+  CProgressJournal(CProgressJournal const &) = delete;
+  CProgressJournal(CProgressJournal &&) = delete;
+  CProgressJournal &operator=(CProgressJournal const &) = delete;
+  CProgressJournal &operator=(CProgressJournal &&) = delete;
+
+  struct header_t
+  {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint8_t reserved[48];
+  };
+  static_assert(sizeof(header_t) == 64, "Journal header must be 64 bytes.");
+
+  static constexpr std::size_t initialCapacity = 2048;    // Records. (64kB)
+
+  int fileDescriptor = -1;
+  void *mapping = nullptr;
+  std::size_t capacity = 0;                   // Records that fit in the file.
+  std::size_t recordCount = 0;                // Records in use.
+  mutable std::mutex mJournal;
+
+  /*! @brief      Returns the records in the mapping.
+   *  @throws     noexcept
+   */
+  record_t *records() const noexcept;
+
+  /*! @brief      Sizes the file and maps it.
+   *  @param[in]  newCapacity: The number of records the file must hold.
+   *  @throws     RUNTIME_ASSERT if the file cannot be sized or mapped.
+   */
+  void resize(std::size_t newCapacity);
+
+  /*! @brief      Calculates the checksum of a record.
+   *  @param[in]  record: The record.
+   *  @returns    The checksum.
+   *  @throws     noexcept
+   */
+  static std::uint32_t checksum(record_t const &record) noexcept;
+};
+
+#endif // WTEXTENSIONS_PROGRESSJOURNAL_H
@@ -0,0 +1,88 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressResource.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Resource that serves the state of a CProgressGroup as JSON.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_PROGRESSRESOURCE_H
+#define WTEXTENSIONS_PROGRESSRESOURCE_H
+
+// Wt Library
+#include <Wt/WResource.h>
+#include <Wt/Http/Request.h>
+#include <Wt/Http/Response.h>
+
+// WtExtensions header files
+#include "include/progressGroup.h"
+
+/* The resource serves the published snapshot of a progress group (CProgressGroup::snapshot()) as JSON. The resource can be
+ * deployed within the session, or as a static resource (WServer::addResource()) for clients that do not have a session.
+ *
+ * GET <url>              Returns all the actions.
+ * GET <url>?since=E-N    Returns only the actions that have changed after snapshot version N of epoch E.
+ *
+ * Each group has a random epoch, so versions from an earlier group or process are not mistaken for current ones. A since from
+ * another epoch is ignored and all the actions are returned. The response carries an ETag of the epoch and snapshot version. If
+ * the request's If-None-Match matches the current version, or since is the current version, 304 (Not Modified) is returned
+ * without a body. An unchanged poll therefore only costs loading the snapshot pointer.
+ *
+ * {"epoch":"3f2a","version":12,"since":0,"eta":4.5,
+ *  "actions":[{"id":1,"parent":0,"text":"Load","status":"active","progress":0.5,"eta":4.5}]}
+ *
+ * The group must outlive the resource.
+ */
+
+class CProgressResource : public Wt::WResource
+{
+public:
+  /*! @brief      Constructor.
+   *  @param[in]  pg: The progress group to serve.
+   */
+  explicit CProgressResource(CProgressGroup const &pg);
+
+  /*! @brief      Destructor.
+   */
+  virtual ~CProgressResource();
+
+  /*! @brief      Handles a request for the resource.
+   *  @param[in]  request: The request.
+   *  @param[in]  response: The response.
+   *  @throws
+   */
+  virtual void handleRequest(Wt::Http::Request const &request, Wt::Http::Response &response) override;
+
+private:
+  CProgressResource() = delete;
+  CProgressResource(CProgressResource const &) = delete;
+  CProgressResource(CProgressResource &&) = delete;
+  CProgressResource &operator=(CProgressResource const &) = delete;
+  CProgressResource &operator=(CProgressResource &&) = delete;
+
+  CProgressGroup const &progressGroup;
+};
+
+#endif // WTEXTENSIONS_PROGRESSRESOURCE_H
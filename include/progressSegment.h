@@ -0,0 +1,195 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressSegment.h
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Shared memory segment used to report progress from other processes.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_PROGRESSSEGMENT_H
+#define WTEXTENSIONS_PROGRESSSEGMENT_H
+
+// Standard C++ header files
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/* A progress segment is a block of shared memory (memfd) divided into fixed size slots. Each slot carries the progress of one
+ * action. The slots are used as a ring, so a segment can report any number of steps over its life, provided no more than the
+ * slot count are in use at once. The segment is created in the parent process and attached to a CProgressGroup. Child processes created with fork()
+ * inherit the mapping and write into it directly. A child that is exec'd can map the segment from the file descriptor (fd())
+ * using the attaching constructor. (The descriptor is created close-on-exec, so the caller must clear FD_CLOEXEC or dup it.)
+ *
+ * Writers
+ * A writer claims a slot with acquireSlot() and then reports into that slot with beginStep(), updateStep() and completeStep().
+ * These are plain stores into the shared memory. There are no system calls and no locks. Each slot must only be written by one
+ * thread at a time. The slot must not be written after completeStep(). Once the reader has seen the completion, the slot is
+ * freed and may be claimed again.
+ *
+ * Reader
+ * The progress group's update thread polls the segment (poll()) and merges the slots into the tree. Each slot is protected by a
+ * sequence counter (seqlock). A slot that is being written when it is polled is picked up on the next poll. Only the latest
+ * value of each slot is seen, so intermediate progress values may be skipped.
+ */
+
+class CProgressSegment
+{
+public:
+  using ID_t = std::uint64_t;
+  using slot_t = std::size_t;
+
+  struct sample_t
+  {
+    ID_t ID;
+    std::uint64_t num;
+    std::uint64_t denom;
+    bool begun;                 // The step has been begun since the last poll.
+    bool completed;             // The step has been completed since the last poll.
+  };
+  using poll_f = std::function<void(sample_t const &)>;
+  struct attach_t {};
+
+  /*! @brief      Constructor. Creates a new segment.
+   *  @param[in]  slotCount: The number of slots in the segment.
+   *  @throws     RUNTIME_ASSERT if the segment cannot be created.
+   */
+  explicit CProgressSegment(std::size_t slotCount = 256);
+
+  /*! @brief      Constructor. Attaches to a segment created by another process.
+   *  @param[in]  attach: Tag parameter. (attach_t{})
+   *  @param[in]  fd: The file descriptor of the segment. The segment takes ownership of the descriptor.
+   *  @throws     RUNTIME_ASSERT if the descriptor is not a progress segment.
+   */
+  CProgressSegment(attach_t, int fd);
+
+  /*! @brief      Destructor. Unmaps the segment and closes the descriptor.
+   */
+  ~CProgressSegment();
+
+  /*! @brief      Returns the file descriptor of the segment.
+   *  @returns    The file descriptor.
+   *  @throws     noexcept
+   */
+  int fd() const noexcept { return fileDescriptor; }
+
+  /*! @brief      Claims a slot for an action.
+   *  @param[in]  actionID: The action that will be reported in the slot.
+   *  @returns    The slot.
+   *  @throws     RUNTIME_ASSERT if all the slots are in use.
+   */
+  slot_t acquireSlot(ID_t actionID);
+
+  /*! @brief      Marks the step as begun.
+   *  @param[in]  slot: The slot returned by acquireSlot().
+   *  @throws     noexcept
+   */
+  void beginStep(slot_t slot) noexcept;
+
+  /*! @brief      Updates the progress of the step.
+   *  @param[in]  slot: The slot returned by acquireSlot().
+   *  @param[in]  num: The numerator of the step progress.
+   *  @param[in]  denom: The denominator of the step progress.
+   *  @throws     noexcept
+   */
+  void updateStep(slot_t slot, std::uint64_t num, std::uint64_t denom) noexcept;
+
+  /*! @brief      Marks the step as complete.
+   *  @param[in]  slot: The slot returned by acquireSlot().
+   *  @throws     noexcept
+   */
+  void completeStep(slot_t slot) noexcept;
+
+  /*! @brief      Reads the slots that have changed since the last poll. Slots that have been completed are freed. Only one thread
+   *              may poll a segment.
+   *  @param[in]  pollFunction: Called for each changed slot.
+   *  @throws
+   */
+  void poll(poll_f const &pollFunction);
+
+private:
+  CProgressSegment(CProgressSegment const &) = delete;
+  CProgressSegment(CProgressSegment &&) = delete;
+  CProgressSegment &operator=(CProgressSegment const &) = delete;
+  CProgressSegment &operator=(CProgressSegment &&) = delete;
+
+  enum slotFlags_e : std::uint64_t { SF_BEGUN = 0x01, SF_COMPLETE = 0x02 };
+
+  // The slots are cache line aligned so that writers in different processes do not share lines.
+
+  struct alignas(64) sharedSlot_t
+  {
+    std::atomic<std::uint64_t> sequence;      // Odd while the slot is being written.
+    std::atomic<std::uint64_t> ID;
+    std::atomic<std::uint64_t> num;
+    std::atomic<std::uint64_t> denom;
+    std::atomic<std::uint64_t> flags;
+    std::atomic<std::uint64_t> inUse;         // Claimed by a writer. Cleared by the reader once the completion is seen.
+  };
+
+  struct alignas(64) sharedHeader_t
+  {
+    std::uint64_t magic;
+    std::uint64_t slotCount;
+    std::atomic<std::uint64_t> nextSlot;      // The ring position at which the next claim starts searching.
+  };
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared memory atomics must be lock free.");
+
+  struct seen_t
+  {
+    std::uint64_t sequence = 0;
+    std::uint64_t flags = 0;
+  };
+
+  int fileDescriptor = -1;
+  std::size_t mappedSize = 0;
+  sharedHeader_t *header = nullptr;
+  sharedSlot_t *slots = nullptr;
+  std::vector<seen_t> seen;                   // Reader state. Local to the polling process.
+
+  /*! @brief      Maps the segment into memory.
+   *  @throws     RUNTIME_ASSERT if the segment cannot be mapped.
+   */
+  void map();
+
+  /*! @brief      Writes a slot. The slot is bracketed by the sequence counter.
+   *  @param[in]  slot: The slot to write.
+   *  @param[in]  writeFunction: Stores the new values.
+   *  @throws     noexcept
+   */
+  template<typename F>
+  void writeSlot(slot_t slot, F writeFunction) noexcept
+  {
+    sharedSlot_t &s = slots[slot];
+    std::uint64_t sequence = s.sequence.load(std::memory_order_relaxed);
+    s.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    writeFunction(s);
+    s.sequence.store(sequence + 2, std::memory_order_release);
+  }
+};
+
+#endif // WTEXTENSIONS_PROGRESSSEGMENT_H
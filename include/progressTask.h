@@ -0,0 +1,330 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressTask.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Coroutine task type that reports into a CProgressGroup.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_PROGRESSTASK_H
+#define WTEXTENSIONS_PROGRESSTASK_H
+
+// Standard C++ header files
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+// WtExtensions header files
+#include "include/progressGroup.h"
+
+/* A CProgressTask is a coroutine that is bound to an action in a CProgressGroup. The first two parameters of the coroutine must
+ * be the progress group and the action ID. These are used to bind the task to the action.
+ *
+ * CProgressTask<std::size_t> loadFiles(CProgressGroup &group, CProgressGroup::ID_t ID, std::vector<path> files)
+ * {
+ *   for (std::size_t index = 0; index != files.size(); index++)
+ *   {
+ *     load(files[index]);
+ *     co_yield progress_t{index + 1, files.size()};
+ *   }
+ *   co_return files.size();
+ * }
+ *
+ * The task is lazy. When it first runs, beginStep() is called. Each co_yield calls updateStep() and the coroutine continues
+ * without suspending. When the coroutine finishes, completeStep() is called. If the coroutine exits with an exception the step is
+ * cancelled and the exception is rethrown by get().
+ *
+ * If the step is cancelled, the next co_yield throws std::system_error (std::errc::operation_canceled). The coroutine can also
+ * poll the step's stop token (CProgressGroup::stopToken) directly.
+ *
+ * The task can be started on an executor with start(), or awaited from another coroutine (in which case it runs on the awaiting
+ * coroutine's thread). An executor is any function that accepts a std::function<void()> and arranges for it to be called.
+ */
+
+struct progress_t
+{
+  std::uint64_t num;
+  std::uint64_t denom;
+};
+
+template<typename T>
+struct progressTaskResult_t
+{
+  std::optional<T> value;
+
+  void return_value(T v) { value.emplace(std::move(v)); }
+};
+
+template<>
+struct progressTaskResult_t<void>
+{
+  void return_void() noexcept {}
+};
+
+template<typename T = void>
+class CProgressTask
+{
+public:
+  using ID_t = CProgressGroup::ID_t;
+  using executor_type = std::function<void(std::function<void()>)>;
+
+  struct promise_type : public progressTaskResult_t<T>
+  {
+    enum state_e { S_RUNNING, S_AWAITED, S_DONE };
+
+    CProgressGroup &progressGroup;
+    ID_t const actionID;
+    std::exception_ptr exception;
+    std::coroutine_handle<> continuation;
+    std::atomic<state_e> state = S_RUNNING;
+
+    // The done flag is held outside the frame. A waiter may destroy the frame as soon as the flag is set, so the notification must
+    // not touch the frame.
+
+    std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+
+    /*! @brief      Constructor. Binds the promise to the action passed as the first two coroutine parameters.
+     *  @param[in]  pg: The progress group.
+     *  @param[in]  ID: The action in the progress group.
+     */
+    template<typename... Args>
+    promise_type(CProgressGroup &pg, ID_t ID, Args const &...) : progressGroup(pg), actionID(ID) {}
+
+    CProgressTask get_return_object() { return CProgressTask(std::coroutine_handle<promise_type>::from_promise(*this), done); }
+
+    auto initial_suspend() noexcept
+    {
+      struct awaiter_t
+      {
+        promise_type &promise;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        void await_resume() const { promise.progressGroup.beginStep(promise.actionID); }
+      };
+      return awaiter_t{*this};
+    }
+
+    auto final_suspend() noexcept
+    {
+      struct awaiter_t
+      {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) const noexcept
+        {
+          promise_type &promise = h.promise();
+
+          if (!promise.exception)
+          {
+            try
+            {
+              promise.progressGroup.completeStep(promise.actionID);
+            }
+            catch(...)
+            {
+              promise.exception = std::current_exception();
+            }
+          }
+          if (promise.exception)
+          {
+            try
+            {
+              promise.progressGroup.cancelStep(promise.actionID);
+            }
+            catch(...)
+            {
+              // The original exception is reported by get().
+            }
+          }
+
+          /* The continuation is only valid once the awaiting coroutine has moved the state to S_AWAITED, so it is read after the
+           * exchange. Only locals are used once the done flag is set, as the frame may be destroyed by a waiter.
+           */
+
+          std::shared_ptr<std::atomic<bool>> done = promise.done;
+          std::coroutine_handle<> continuation = std::noop_coroutine();
+          if (promise.state.exchange(S_DONE) == S_AWAITED)
+          {
+            continuation = promise.continuation;
+          }
+          done->store(true);
+          done->notify_all();
+
+          return continuation;
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter_t{};
+    }
+
+    std::suspend_never yield_value(progress_t p)
+    {
+      throwIfCancelled();
+      progressGroup.updateStep(actionID, p.num, p.denom);
+      return {};
+    }
+
+    std::suspend_never yield_value(double p)
+    {
+      throwIfCancelled();
+      progressGroup.updateStep(actionID, p);
+      return {};
+    }
+
+    void throwIfCancelled() const
+    {
+      if (progressGroup.stopToken(actionID).stop_requested())
+      {
+        throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+      }
+    }
+
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  CProgressTask(CProgressTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)), done(std::move(other.done)),
+    started(other.started) {}
+
+  /*! @brief      Destructor. If the task has been started and not finished, waits for it to finish.
+   */
+  ~CProgressTask()
+  {
+    if (handle)
+    {
+      if (started)
+      {
+        wait();
+      }
+      handle.destroy();
+    }
+  }
+
+  /*! @brief      Starts the task on the executor.
+   *  @param[in]  executor: The executor to run the task on.
+   *  @throws     CODE_ERROR if the task has already been started.
+   */
+  void start(executor_type const &executor)
+  {
+    if (started)
+    {
+      CODE_ERROR();
+      // Does not return.
+    }
+    started = true;
+    executor([h = handle]() { h.resume(); });
+  }
+
+  /*! @brief      Determines if the task has finished.
+   *  @returns    true if the task has finished.
+   *  @throws     noexcept
+   */
+  [[nodiscard]] bool isDone() const noexcept { return done->load(); }
+
+  /*! @brief      Blocks until the task has finished. The task must have been started.
+   *  @throws     noexcept
+   */
+  void wait() const noexcept { done->wait(false); }
+
+  /*! @brief      Waits for the task to finish and returns the result. Rethrows any exception thrown by the task.
+   *  @returns    The result of the task.
+   *  @throws     Any exception thrown by the task.
+   */
+  T get()
+  {
+    wait();
+    if (handle.promise().exception)
+    {
+      std::rethrow_exception(handle.promise().exception);
+    }
+    if constexpr (!std::is_void_v<T>)
+    {
+      return std::move(*handle.promise().value);
+    }
+  }
+
+  /*! @brief      Allows the task to be awaited from another coroutine. If the task has not been started, it is run on the thread
+   *              of the awaiting coroutine.
+   */
+  auto operator co_await() & noexcept { return awaiter_t{*this}; }
+
+  /*! @brief      Allows a temporary task to be awaited, eg co_await child(group, ID). The temporary lives until the awaiting
+   *              coroutine resumes.
+   */
+  auto operator co_await() && noexcept { return awaiter_t{*this}; }
+
+private:
+  struct awaiter_t
+  {
+    CProgressTask &task;
+
+    bool await_ready() const noexcept { return task.started && task.isDone(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+      promise_type &promise = task.handle.promise();
+      promise.continuation = awaiting;
+
+      if (!task.started)
+      {
+        task.started = true;
+        promise.state = promise_type::S_AWAITED;
+        return task.handle;
+      }
+      else
+      {
+        typename promise_type::state_e expected = promise_type::S_RUNNING;
+        if (promise.state.compare_exchange_strong(expected, promise_type::S_AWAITED))
+        {
+          return std::noop_coroutine();
+        }
+        else
+        {
+          return awaiting;      // Already finished.
+        }
+      }
+    }
+    T await_resume() { return task.get(); }
+  };
+
+  CProgressTask() = delete;
+  CProgressTask(CProgressTask const &) = delete;
+  CProgressTask &operator=(CProgressTask const &) = delete;
+  CProgressTask &operator=(CProgressTask &&) = delete;
+
+  CProgressTask(handle_type h, std::shared_ptr<std::atomic<bool>> d) noexcept : handle(h), done(std::move(d)) {}
+
+  handle_type handle;
+  std::shared_ptr<std::atomic<bool>> done;
+  bool started = false;
+};
+
+#endif // WTEXTENSIONS_PROGRESSTASK_H
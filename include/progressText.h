@@ -33,7 +33,12 @@
 
   // Standard C++ library
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <streambuf>
+#include <string>
 #include <ostream>
 
   // Wt++ header files
@@ -41,15 +46,32 @@
 #include <Wt/WApplication.h>
 #include <Wt/WText.h>
 
-class CProgressText : private std::streambuf, public std::ostream, public Wt::WText
+  // WtExtensions header files
+
+#include "include/pullMode.h"
+
+/* Characters written to the stream are appended to a buffer, which is appended to the text in the GUI thread.
+ * In push mode (the default) the first character written to an empty buffer posts an update to the application's mailbox.
+ * In pull mode (setPullMode()) a timer in the browser requests the changes at the pull interval. In neither mode do worker
+ * threads take the update lock.
+ */
+
+class CProgressText : private std::streambuf, public std::ostream, public Wt::WText, public CPullMode
 {
 public:
   using Traits = std::streambuf::traits_type;
 
   CProgressText();
 
+
 private:
   Wt::WApplication *app = nullptr;
+  std::mutex mPending;
+  std::string pendingText;
+
+  /*! @brief      Appends the buffered text. Called from the GUI thread.
+   */
+  virtual void applyPending() override;
 
   virtual std::streambuf::int_type overflow(int c) override;
   virtual void updateDom(Wt::DomElement& element, bool all) override;
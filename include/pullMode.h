@@ -0,0 +1,96 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                pullMode.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Pull mode support for widgets that are updated from outside the GUI thread.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+
+#ifndef WTEXTENSIONS_PULLMODE_H
+#define WTEXTENSIONS_PULLMODE_H
+
+// Standard C++ header files
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+// Wt library
+#include <Wt/WObject.h>
+#include <Wt/WTimer.h>
+
+// WtExtensions header files
+#include "include/updateMailbox.h"
+
+/* CPullMode is a base class for the widgets that store changes made outside the GUI thread and apply them in the GUI thread
+ * (applyPending()).
+ * In push mode (the default) the widget posts the changes to the application's mailbox, and the widget holds a push reference on
+ * the mailbox. The closure that is posted (applyClosure) is created by the constructor, as bindSafe() must be called from the GUI
+ * thread. Server push is enabled while any widget (or other user) holds a reference.
+ * In pull mode the widget posts nothing. A timer in the browser requests the changes at the pull interval and applyPending() is
+ * called in the GUI thread. The push reference is released, so once every user is in pull mode the application's server push
+ * (long poll) connection is closed. This is useful behind proxies that do not handle long-lived connections.
+ */
+
+class CPullMode
+{
+public:
+  /*! @brief      Selects pull mode. Must be called from the GUI thread.
+   *  @param[in]  interval: The interval at which the browser requests changes. (0 = return to push mode)
+   *  @throws
+   */
+  void setPullMode(std::chrono::milliseconds interval);
+
+protected:
+  std::shared_ptr<CUpdateMailbox> mailbox;
+  std::atomic<bool> pullMode = false;
+  CUpdateMailbox::closure_type applyClosure;          // Calls applyPending(). Post this from other threads.
+
+  /*! @brief      Constructor. Must be called from the GUI thread.
+   *  @param[in]  owner: The widget. The pull timer is added as a child of the widget.
+   *  @param[in]  mb: The application's mailbox.
+   */
+  CPullMode(Wt::WObject &owner, std::shared_ptr<CUpdateMailbox> mb);
+
+  /*! @brief      Destructor. Releases the push reference.
+   */
+  virtual ~CPullMode();
+
+  /*! @brief      Applies the stored changes. Called from the GUI thread.
+   */
+  virtual void applyPending() = 0;
+
+private:
+  CPullMode() = delete;
+  CPullMode(CPullMode const &) = delete;
+  CPullMode(CPullMode &&) = delete;
+  CPullMode &operator=(CPullMode const &) = delete;
+  CPullMode &operator=(CPullMode &&) = delete;
+
+  Wt::WObject &owner;
+  Wt::WTimer *pullTimer = nullptr;
+};
+
+#endif // WTEXTENSIONS_PULLMODE_H
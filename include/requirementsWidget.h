@@ -35,20 +35,35 @@
  *  The first column lists the requirement.
  *  The second column indicates if the requirement is "required" or "optional"
  *  The third column displays text indicating whether the requirement has been met.
+ * The model is only created, and the view set up, when the widget is first rendered. Requirements inserted and changed before
+ * then are held in a list and loaded into the model when it is created.
  */
 
 // Standard C++ library
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 // Wt library
 #include <Wt/WAbstractItemModel.h>
 #include <Wt/WTableView.h>
 
-class CRequirementsWidget : public Wt::WTableView
+// WtExtensions header files
+#include "include/pullMode.h"
+
+/* changeStatus() called outside the GUI thread records the status. In push mode the status is applied through the application's
+ * mailbox. In pull mode (setPullMode()) a timer in the browser requests the changes at the pull interval and the status is applied
+ * in the GUI thread.
+ */
+
+class CRequirementsWidget : public Wt::WTableView, public CPullMode
 {
 public:
   using ID_t = std::uint64_t;       // Identifier type to identify the specific requirement.
@@ -76,6 +91,11 @@ public:
 protected:
   void createUI();
 
+  /*! @brief      Creates the UI on the first render.
+   *  @param[in]  flags: The render flags.
+   */
+  virtual void render(Wt::WFlags<Wt::RenderFlag> flags) override;
+
 
 private:
   CRequirementsWidget() = delete;
@@ -86,6 +106,29 @@ private:
 
   std::shared_ptr<Wt::WAbstractItemModel> model;
   Wt::WApplication &application;
+  std::mutex mPending;
+  std::map<ID_t, bool> pendingStatus;
+
+  struct pendingRecord_t
+  {
+    ID_t ID;
+    std::string shortText;
+    requirementType_e requirementType;
+    bool available = false;
+  };
+  std::vector<pendingRecord_t> pendingRecords;        // Requirements inserted before the model is created.
+
+  /*! @brief      Applies the recorded status changes. Called from the GUI thread.
+   */
+  virtual void applyPending() override;
+
+  /*! @brief      Changes the status of a requirement in the model, or in the pending list if the model has not been created.
+   *              Called from the GUI thread.
+   *  @param[in]  ID: The requirement to change.
+   *  @param[in]  enable: The status.
+   *  @throws     RUNTIME_ASSERT if the requirement does not exist.
+   */
+  void applyStatus(ID_t ID, bool enable);
 };
 
 
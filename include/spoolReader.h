@@ -0,0 +1,84 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                spoolReader.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Reads the data appended to a spool file while it is being uploaded.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_SPOOLREADER_H
+#define WTEXTENSIONS_SPOOLREADER_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <span>
+
+/* Chunked uploads are appended to the spool file as each chunk arrives. The reader remembers how much of the spool file has been
+ * read, so each call to read() passes only the data appended since the previous call. The data can then be processed while the
+ * upload is in progress rather than after it has completed.
+ */
+
+class CSpoolReader
+{
+public:
+  using read_f = std::function<void(std::span<char const>)>;
+
+  /*! @brief      Constructor.
+   *  @param[in]  spoolFile: The spool file. The file need not exist yet.
+   */
+  explicit CSpoolReader(std::filesystem::path const &spoolFile) : spoolFile_(spoolFile) {}
+  ~CSpoolReader() = default;
+
+  /*! @brief      Passes the data appended since the last call to the function, in blocks.
+   *  @param[in]  readFunction: The function to call with each block.
+   *  @returns    The number of bytes read.
+   *  @throws
+   */
+  std::uint64_t read(read_f const &readFunction);
+
+  /*! @brief      Returns the number of bytes that have been read.
+   *  @returns    The position in the spool file.
+   *  @throws     noexcept
+   */
+  std::uint64_t position() const noexcept { return position_; }
+
+private:
+  CSpoolReader() = delete;
+  CSpoolReader(CSpoolReader const &) = delete;
+  CSpoolReader(CSpoolReader &&) = delete;
+  CSpoolReader &operator=(CSpoolReader const &) = delete;
+  CSpoolReader &operator=(CSpoolReader &&) = delete;
+
+  static constexpr std::size_t blockSize = 65536;
+
+  std::filesystem::path const spoolFile_;
+  std::ifstream input;
+  std::uint64_t position_ = 0;
+};
+
+#endif // WTEXTENSIONS_SPOOLREADER_H
@@ -0,0 +1,162 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                stepExecutor.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Executes the steps of a CProgressGroup in parallel.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_STEPEXECUTOR_H
+#define WTEXTENSIONS_STEPEXECUTOR_H
+
+// Standard C++ header files
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+// WtExtensions header files
+#include "include/progressGroup.h"
+#include "include/threadPool.h"
+
+/* The step executor runs a plan of steps on a thread pool. The steps must already have been inserted into the progress group.
+ * The executor calls beginStep() and completeStep() on the group. The step function only needs to report progress.
+ *
+ * Ordering is determined by the group's parent/child tree and by explicit dependencies.
+ * > A step is ready when all of its dependencies have completed and its parent (if the parent is in the plan) has begun.
+ * > Independent ready steps run concurrently, up to the concurrency limit.
+ * > A step with children in the plan is a stage. The stage is begun when it becomes ready, its children then run, and the
+ *   stage's own function (if any) runs once all the children have completed. The stage then completes. A dependency on a
+ *   stage is therefore a dependency on the whole subtree.
+ *
+ * If a step function throws, the step is cancelled and no further steps are started. run() waits for the running steps, cancels
+ * the stages that were begun and rethrows the first exception. The stages are also cancelled if the dependencies contain a cycle.
+ *
+ * Each step is begun on the thread that runs its function, so that the group measures its CPU time.
+ *
+ * Each step function is passed the step's stop token from the progress group. A step that is cancelled (CProgressGroup::cancelStep
+ * or cancelSubtree) before it starts is not run. A step that returns after being cancelled is not completed. The steps that
+ * depend on a cancelled step are cancelled as well. Cancelled steps count as finished, so run() returns normally.
+ *
+ * Steps that are already complete in the progress group (for example, restored from a CProgressJournal) are not run.
+ */
+
+class CStepExecutor
+{
+public:
+  using ID_t = CProgressGroup::ID_t;
+  using step_f = std::function<void(std::stop_token)>;
+
+  /*! @brief      Constructor.
+   *  @param[in]  pg: The progress group that holds the steps.
+   *  @param[in]  tp: The thread pool to execute the steps on.
+   *  @param[in]  mc: The maximum number of steps to run concurrently. (0 = the size of the thread pool)
+   *  @throws
+   */
+  CStepExecutor(CProgressGroup &pg, CThreadPool &tp, std::size_t mc = 0);
+  ~CStepExecutor() = default;
+
+  /*! @brief      Adds a step to the plan.
+   *  @param[in]  stepID: The action ID of the step. (Must exist in the progress group.)
+   *  @param[in]  stepFunction: The function to execute. May be empty for a stage.
+   *  @param[in]  dependsOn: The steps that must complete before this step can begin.
+   *  @throws     CODE_ERROR if the step has already been added.
+   */
+  void addStep(ID_t stepID, step_f stepFunction, std::initializer_list<ID_t> dependsOn = {});
+
+  /*! @brief      Adds a dependency edge between two steps.
+   *  @param[in]  stepID: The dependent step.
+   *  @param[in]  dependsOn: The step that must complete first.
+   *  @throws
+   */
+  void addDependency(ID_t stepID, ID_t dependsOn);
+
+  /*! @brief      Executes the plan. Blocks until all the steps have completed.
+   *  @throws     Rethrows the first exception thrown by a step function.
+   *  @throws     RUNTIME_ASSERT if a dependency does not exist or the dependencies contain a cycle.
+   */
+  void run();
+
+private:
+  CStepExecutor() = delete;
+  CStepExecutor(CStepExecutor const &) = delete;
+  CStepExecutor(CStepExecutor &&) = delete;
+  CStepExecutor &operator=(CStepExecutor const &) = delete;
+  CStepExecutor &operator=(CStepExecutor &&) = delete;
+
+  enum stepStatus_e { SS_WAITING, SS_READY, SS_BEGUN, SS_RUNNING, SS_COMPLETE };
+
+  struct step_t
+  {
+    ID_t ID;
+    step_f stepFunction;
+    std::vector<ID_t> dependsOn;
+    std::vector<ID_t> dependents;
+    std::vector<ID_t> children;
+    ID_t parent = 0;                  // Parent in the plan. (0 if the parent is not in the plan.)
+    std::size_t unmetDependencies = 0;
+    std::size_t childrenRemaining = 0;
+    stepStatus_e status = SS_WAITING;
+  };
+
+  CProgressGroup &progressGroup;
+  CThreadPool &threadPool;
+  std::size_t maxConcurrent;
+  std::map<ID_t, step_t> steps;
+  std::mutex mSteps;
+  std::condition_variable cvComplete;
+  std::deque<ID_t> readyQueue;
+  std::size_t running = 0;
+  std::size_t completed = 0;
+  std::exception_ptr exception;
+
+  /*! @brief      Marks a step as ready if all its dependencies are met and its parent has begun. mSteps must be held.
+   *  @param[in]  step: The step to check.
+   */
+  void checkReady(step_t &step);
+
+  /*! @brief      Starts ready steps up to the concurrency limit. mSteps must be held.
+   */
+  void dispatch();
+
+  /*! @brief      Executes a step function on the thread pool.
+   *  @param[in]  stepID: The step to execute.
+   */
+  void execute(ID_t stepID);
+
+  /*! @brief      Completes a step and releases the dependent steps. mSteps must be held.
+   *  @param[in]  step: The step that has completed.
+   *  @param[in]  cancelled: true if the step was cancelled. The dependent steps are then cancelled as well.
+   */
+  void finish(step_t &step, bool cancelled = false);
+};
+
+#endif // WTEXTENSIONS_STEPEXECUTOR_H
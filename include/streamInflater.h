@@ -0,0 +1,104 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                streamInflater.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Decompresses a gzip stream into a file.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_STREAMINFLATER_H
+#define WTEXTENSIONS_STREAMINFLATER_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <span>
+
+// Miscellaneous library header files
+#include <zlib.h>
+
+/* The inflater is given the compressed data in pieces as it arrives and writes the decompressed data to the output file. The
+ * input may be a series of gzip members, as produced by compressing each chunk of an upload separately. If the input is not
+ * gzip data, the inflater stops and failed() returns true. The decompressed data can also be passed to a function as it is written.
+ */
+
+class CStreamInflater
+{
+public:
+  using output_f = std::function<void(std::span<char const>)>;
+
+  /*! @brief      Constructor.
+   *  @param[in]  outputFile: The file to write the decompressed data to. Any existing file is replaced.
+   *  @param[in]  outputFunction: Function to call with the decompressed data. (Optional)
+   *  @throws     RUNTIME_ASSERT if the inflater cannot be initialised.
+   */
+  explicit CStreamInflater(std::filesystem::path const &outputFile, output_f outputFunction = {});
+
+  /*! @brief      Destructor.
+   */
+  ~CStreamInflater();
+
+  /*! @brief      Decompresses the data.
+   *  @param[in]  data: The compressed data.
+   *  @throws
+   */
+  void write(std::span<char const> data);
+
+  /*! @brief      Finishes the stream. The output file is closed.
+   *  @returns    true if the input was complete and valid.
+   *  @throws
+   */
+  bool finish();
+
+  /*! @brief      Returns true if the input was not valid gzip data.
+   *  @throws     noexcept
+   */
+  bool failed() const noexcept { return failed_; }
+
+  /*! @brief      Returns the number of bytes that have been decompressed.
+   *  @throws     noexcept
+   */
+  std::uint64_t size() const noexcept { return size_; }
+
+private:
+  CStreamInflater() = delete;
+  CStreamInflater(CStreamInflater const &) = delete;
+  CStreamInflater(CStreamInflater &&) = delete;
+  CStreamInflater &operator=(CStreamInflater const &) = delete;
+  CStreamInflater &operator=(CStreamInflater &&) = delete;
+
+  static constexpr std::size_t blockSize = 65536;
+
+  z_stream stream{};
+  std::ofstream output;
+  output_f outputFunction_;
+  bool failed_ = false;
+  bool memberComplete = true;       // No member has been started, or the last member has been completed.
+  std::uint64_t size_ = 0;
+};
+
+#endif // WTEXTENSIONS_STREAMINFLATER_H
@@ -0,0 +1,113 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                threadPool.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Work-stealing thread pool.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_THREADPOOL_H
+#define WTEXTENSIONS_THREADPOOL_H
+
+// Standard C++ header files
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Each worker thread has its own queue. Tasks submitted from a worker are pushed onto the back of that worker's queue and the
+ * worker pops from the back (LIFO), which keeps related work on the same thread. Tasks submitted from outside the pool are
+ * distributed round-robin. A worker with an empty queue steals from the front of the other queues (FIFO).
+ *
+ * The destructor waits for all submitted tasks to complete before joining the threads. Tasks must not throw.
+ */
+
+class CThreadPool
+{
+public:
+  using task_type = std::function<void()>;
+
+  /*! @brief      Constructor. Starts the worker threads.
+   *  @param[in]  threadCount: The number of worker threads. (0 = hardware concurrency)
+   *  @throws
+   */
+  explicit CThreadPool(std::size_t threadCount = 0);
+
+  /*! @brief      Destructor. Waits for all the tasks to complete and joins the threads.
+   */
+  ~CThreadPool();
+
+  /*! @brief      Submits a task to the pool.
+   *  @param[in]  task: The task to execute.
+   *  @throws
+   */
+  void submit(task_type task);
+
+  /*! @brief      Returns the number of worker threads.
+   *  @returns    The number of worker threads.
+   *  @throws     noexcept
+   */
+  std::size_t size() const noexcept { return threads.size(); }
+
+private:
+  CThreadPool(CThreadPool const &) = delete;
+  CThreadPool(CThreadPool &&) = delete;
+  CThreadPool &operator=(CThreadPool const &) = delete;
+  CThreadPool &operator=(CThreadPool &&) = delete;
+
+  struct queue_t
+  {
+    std::mutex mQueue;
+    std::deque<task_type> tasks;
+  };
+
+  std::vector<std::unique_ptr<queue_t>> queues;
+  std::vector<std::thread> threads;
+  std::atomic<std::size_t> nextQueue = 0;
+  std::atomic<std::size_t> pendingTasks = 0;
+  std::mutex mWake;
+  std::condition_variable cvWake;
+  bool terminateThreads = false;
+
+  /*! @brief      Pops a task from the worker's own queue, or steals one from another queue.
+   *  @param[in]  index: The index of the worker.
+   *  @param[out] task: The task.
+   *  @returns    true if a task was found.
+   *  @throws
+   */
+  bool popTask(std::size_t index, task_type &task);
+
+  /*! @brief      The worker thread function.
+   *  @param[in]  index: The index of the worker.
+   */
+  void workerThread(std::size_t index);
+};
+
+#endif // WTEXTENSIONS_THREADPOOL_H
@@ -0,0 +1,124 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                updateMailbox.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Per-application mailbox that applies UI updates from worker threads in a single pass.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_UPDATEMAILBOX_H
+#define WTEXTENSIONS_UPDATEMAILBOX_H
+
+// Standard C++ header files
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Wt library
+#include <Wt/WApplication.h>
+
+/* Worker threads post closures to the application's mailbox rather than taking the update lock themselves. The first closure
+ * posted to an empty mailbox schedules a drain with WServer::post(). The drain runs in the session (with the update lock held),
+ * calls all the closures that have been posted and then calls triggerUpdate() once. However many widgets are updated, there is
+ * one lock acquisition and one push per drain.
+ *
+ * Closures posted from the GUI thread are called immediately.
+ *
+ * The closures are called after post() returns, so they must not capture references to objects that may be destroyed first.
+ * Closures that update a widget should be wrapped with the widget's bindSafe(). bindSafe() must be called from the GUI thread, so
+ * the closure is created there (eg in the widget's constructor) and the same closure is posted from the other threads.
+ *
+ * There is one mailbox per application. The mailbox must first be obtained (instance()) from the GUI thread. The widgets do this
+ * in their constructors. The mailbox is closed when the application is destroyed, and closures posted after that are discarded.
+ *
+ * Server push is reference counted. Each user that relies on posted closures being pushed to the browser holds a reference
+ * (requirePush()). Server push is enabled while there are any references, and disabled when the last is released. Widgets in
+ * pull mode (CPullMode) do not hold a reference.
+ */
+
+class CUpdateMailbox : public std::enable_shared_from_this<CUpdateMailbox>
+{
+public:
+  using closure_type = std::function<void()>;
+
+  /*! @brief      Returns the mailbox of the application, creating it if required.
+   *  @param[in]  application: The application.
+   *  @returns    The mailbox.
+   *  @throws
+   */
+  static std::shared_ptr<CUpdateMailbox> instance(Wt::WApplication &application);
+
+  /*! @brief      Constructor. Use instance() to obtain the mailbox.
+   *  @param[in]  application: The application.
+   */
+  explicit CUpdateMailbox(Wt::WApplication &application);
+  ~CUpdateMailbox() = default;
+
+  /*! @brief      Posts a closure to be called in the GUI thread.
+   *  @param[in]  closure: The closure.
+   *  @throws
+   */
+  void post(closure_type closure);
+
+  /*! @brief      Adds or releases a reference on server push. Server push is enabled while there are any references. Must be
+   *              called from the GUI thread.
+   *  @param[in]  require: true to add a reference, false to release one.
+   *  @throws
+   */
+  void requirePush(bool require);
+
+private:
+  CUpdateMailbox() = delete;
+  CUpdateMailbox(CUpdateMailbox const &) = delete;
+  CUpdateMailbox(CUpdateMailbox &&) = delete;
+  CUpdateMailbox &operator=(CUpdateMailbox const &) = delete;
+  CUpdateMailbox &operator=(CUpdateMailbox &&) = delete;
+
+  friend class CUpdateMailboxGuard;
+
+  Wt::WApplication &application;
+  std::mutex mMailbox;
+  std::vector<closure_type> closures;
+  bool drainScheduled = false;
+  bool closed = false;
+  std::size_t pushReferences = 0;
+
+  /*! @brief      Calls all the posted closures and pushes the changes. Called in the session.
+   */
+  void drain();
+
+  /*! @brief      Clears the scheduled drain when the session could not be found, so that the next post schedules a drain again.
+   *              Called from a server thread.
+   */
+  void drainFailed();
+
+  /*! @brief      Closes the mailbox. Called when the application is destroyed.
+   */
+  void close();
+};
+
+#endif // WTEXTENSIONS_UPDATEMAILBOX_H
@@ -0,0 +1,83 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadConsumer.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Interface for processing uploaded files while they are received.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_UPLOADCONSUMER_H
+#define WTEXTENSIONS_UPLOADCONSUMER_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <span>
+#include <string>
+
+/* A consumer registered with a CFileUploadWidget (addConsumer()) receives the data of each file as it arrives, so the file can be
+ * parsed while the rest of it is still being transferred. The data is the file's content, in order, from the start of the file.
+ * For compressed uploads it is the decompressed data.
+ *
+ * For each file the consumer receives begin(), any number of calls to data() and then end(). If the file completes, complete is
+ * true and the data received is the whole file. If the upload fails, is skipped or the widget is cleared, complete is false and
+ * the data received so far should be discarded.
+ *
+ * The data received while the upload is in flight cannot always be used. Resumed uploads and files the browser did not compress
+ * are only streamed when the upload completes, and a file linked from the content store is streamed from the linked file. When
+ * a file has already been partly streamed in these cases, end() is called with complete false and the file is streamed again
+ * from begin().
+ *
+ * The functions are called from the GUI thread, with the data that arrived with each progress update. They should be quick, or
+ * hand the data to another thread. The span is only valid for the duration of the call. end() must not throw.
+ */
+
+class CUploadConsumer
+{
+public:
+  using ID_t = std::uint32_t;
+
+  virtual ~CUploadConsumer() = default;
+
+  /*! @brief      Called before the first data of a file.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  clientFileName: The client file name.
+   *  @param[in]  size: The size of the file.
+   */
+  virtual void begin(ID_t fileID, std::string const &clientFileName, std::uint64_t size) {}
+
+  /*! @brief      Called with the next part of the file.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  data: The data.
+   */
+  virtual void data(ID_t fileID, std::span<char const> data) = 0;
+
+  /*! @brief      Called after the last data of a file.
+   *  @param[in]  fileID: The file's ID.
+   *  @param[in]  complete: true if the whole file has been received.
+   */
+  virtual void end(ID_t fileID, bool complete) noexcept {}
+};
+
+#endif // WTEXTENSIONS_UPLOADCONSUMER_H
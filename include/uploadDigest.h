@@ -0,0 +1,84 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadDigest.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Computes a set of message digests incrementally.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_UPLOADDIGEST_H
+#define WTEXTENSIONS_UPLOADDIGEST_H
+
+// Standard C++ header files
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+// Miscellaneous library header files
+#include <openssl/evp.h>
+
+/* Computes one or more digests (OpenSSL names, eg "SHA256", "SHA512", "MD5") over data that is passed in pieces. Each piece is
+ * passed to all the digests, so the data only needs to be read once however many digests are required.
+ */
+
+class CUploadDigest
+{
+public:
+  using digests_t = std::map<std::string, std::string>;     // Digest name, hex digest.
+
+  /*! @brief      Constructor.
+   *  @param[in]  digestNames: The digests to compute.
+   *  @throws     RUNTIME_ASSERT if a digest is not known to OpenSSL.
+   */
+  explicit CUploadDigest(std::vector<std::string> const &digestNames);
+
+  /*! @brief      Destructor.
+   */
+  ~CUploadDigest();
+
+  /*! @brief      Adds data to the digests.
+   *  @param[in]  data: The data.
+   *  @throws
+   */
+  void update(std::span<char const> data);
+
+  /*! @brief      Finishes the digests. No more data may be added.
+   *  @returns    The digests in hex.
+   *  @throws
+   */
+  digests_t final();
+
+private:
+  CUploadDigest() = delete;
+  CUploadDigest(CUploadDigest const &) = delete;
+  CUploadDigest(CUploadDigest &&) = delete;
+  CUploadDigest &operator=(CUploadDigest const &) = delete;
+  CUploadDigest &operator=(CUploadDigest &&) = delete;
+
+  std::vector<std::pair<std::string, EVP_MD_CTX *>> contexts;
+};
+
+#endif // WTEXTENSIONS_UPLOADDIGEST_H
@@ -0,0 +1,133 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadGovernor.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Process-wide admission control of uploads against a disk budget.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_UPLOADGOVERNOR_H
+#define WTEXTENSIONS_UPLOADGOVERNOR_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* The governor limits the bytes that uploads may hold on the spool disk. One governor is shared by all the sessions of the
+ * server (CFileUploadWidget::uploadGovernor()). Before a file is sent, its size (as declared by the browser) is reserved against
+ * the total budget and against the quota of the session. The reservation is released when the file leaves the spool, or when
+ * the upload fails.
+ *
+ * A request that does not fit waits in a queue until enough is released. Requests are admitted in order. A request waiting for
+ * the total budget is not overtaken by later requests, so large files are not starved. A request waiting only for its own
+ * session's quota does not hold up the other sessions. A file that is larger than the budget or the quota is refused.
+ *
+ * The admitted function of a queued request is called when it is admitted, from the thread that released the reservation, with
+ * no locks held.
+ */
+
+class CUploadGovernor
+{
+public:
+  using ticket_t = std::uint64_t;
+  using admitted_f = std::function<void(ticket_t)>;
+  enum admission_e
+  {
+    A_ADMITTED,     // The size has been reserved.
+    A_QUEUED,       // The request is waiting. The admitted function is called when the size has been reserved.
+    A_REFUSED,      // The size exceeds the budget or the quota.
+  };
+
+  /*! @brief      Constructor.
+   *  @param[in]  totalBudget: The bytes that all the uploads may hold.
+   *  @param[in]  sessionQuota: The bytes that the uploads of one session may hold.
+   */
+  CUploadGovernor(std::uint64_t totalBudget, std::uint64_t sessionQuota);
+  ~CUploadGovernor() = default;
+
+  /*! @brief      Requests admission of an upload.
+   *  @param[in]  sessionID: The session.
+   *  @param[in]  size: The size of the file.
+   *  @param[out] ticket: The ticket of the request. (0 if refused)
+   *  @param[in]  admitted: The function to call when a queued request is admitted.
+   *  @returns    The admission.
+   *  @throws
+   */
+  admission_e request(std::string const &sessionID, std::uint64_t size, ticket_t &ticket, admitted_f admitted);
+
+  /*! @brief      Releases an admitted reservation, or withdraws a queued request. Queued requests that now fit are admitted.
+   *  @param[in]  ticket: The ticket of the request.
+   *  @throws
+   */
+  void release(ticket_t ticket);
+
+  /*! @brief      Returns the bytes reserved by the admitted uploads.
+   *  @returns    The bytes reserved.
+   */
+  std::uint64_t reserved() const;
+
+  /*! @brief      Returns the number of requests waiting.
+   *  @returns    The number of requests waiting.
+   */
+  std::size_t queued() const;
+
+private:
+  CUploadGovernor() = delete;
+  CUploadGovernor(CUploadGovernor const &) = delete;
+  CUploadGovernor(CUploadGovernor &&) = delete;
+  CUploadGovernor &operator=(CUploadGovernor const &) = delete;
+  CUploadGovernor &operator=(CUploadGovernor &&) = delete;
+
+  struct request_t
+  {
+    ticket_t ticket;
+    std::string sessionID;
+    std::uint64_t size;
+    admitted_f admitted;
+  };
+  using admittedList_t = std::vector<std::pair<ticket_t, admitted_f>>;
+
+  std::uint64_t const totalBudget;
+  std::uint64_t const sessionQuota;
+  mutable std::mutex mGovernor;
+  std::uint64_t reserved_ = 0;
+  std::map<std::string, std::uint64_t> reservedBySession;
+  std::map<ticket_t, std::pair<std::string, std::uint64_t>> reservations;
+  std::list<request_t> queue;
+  ticket_t lastTicket = 0;
+
+  /*! @brief      Admits the queued requests that fit. Called with mGovernor held.
+   *  @returns    The tickets and admitted functions of the requests admitted.
+   */
+  admittedList_t admitQueued();
+};
+
+#endif // WTEXTENSIONS_UPLOADGOVERNOR_H
@@ -0,0 +1,122 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadResumeStore.h
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Server-side store of partially uploaded files.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#ifndef WTEXTENSIONS_UPLOADRESUMESTORE_H
+#define WTEXTENSIONS_UPLOADRESUMESTORE_H
+
+// Standard C++ header files
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+/* The store holds the part of a file that was received before its upload was interrupted. Only whole chunks are kept, so the
+ * offset of a stored file is always a multiple of the chunk size. When the file is dropped again, CFileUploadWidget looks up the
+ * offset and the browser skips the chunks the server already holds. When the upload completes, the stored part and the newly
+ * received data are joined.
+ *
+ * Files are identified by their client file name, size and modification time. The store should therefore be scoped to a user,
+ * and must outlive the sessions that use it if uploads are to be resumed in a new session.
+ */
+
+class CUploadResumeStore
+{
+public:
+  /*! @brief      Constructor.
+   *  @param[in]  directory: The directory to hold the partial files. Created if it does not exist.
+   *  @throws     std::filesystem::filesystem_error
+   */
+  explicit CUploadResumeStore(std::filesystem::path const &directory);
+  ~CUploadResumeStore() = default;
+
+  /*! @brief      Returns the key that identifies a file. The modification time keeps apart files with the same name and size.
+   *  @param[in]  clientFileName: The client file name.
+   *  @param[in]  size: The size of the file.
+   *  @param[in]  lastModified: The modification time reported by the browser. (File.lastModified, ms. 0 = not known)
+   *  @returns    The key.
+   */
+  static std::string key(std::string const &clientFileName, std::uint64_t size, std::uint64_t lastModified);
+
+  /*! @brief      Returns the number of bytes of a file that are held.
+   *  @param[in]  key: The file.
+   *  @returns    The offset to resume from. Zero if the file is not held.
+   *  @throws
+   */
+  std::uint64_t offset(std::string const &key) const;
+
+  /*! @brief      Appends the whole chunks of an interrupted upload to the part held for the file.
+   *  @param[in]  key: The file.
+   *  @param[in]  spoolFile: The data received by the interrupted upload.
+   *  @param[in]  chunkSize: The chunk size of the upload.
+   *  @throws     RUNTIME_ASSERT if the data cannot be stored.
+   */
+  void save(std::string const &key, std::filesystem::path const &spoolFile, std::uint64_t chunkSize);
+
+  /*! @brief      Completes a resumed upload. The part held is joined with the remainder and replaces the spool file.
+   *  @param[in]  key: The file.
+   *  @param[in]  spoolFile: The remainder of the file. On return this holds the whole file.
+   *  @throws     RUNTIME_ASSERT if the file cannot be joined.
+   */
+  void complete(std::string const &key, std::filesystem::path const &spoolFile);
+
+  /*! @brief      Discards the part held for a file.
+   *  @param[in]  key: The file.
+   *  @throws
+   */
+  void discard(std::string const &key);
+
+private:
+  CUploadResumeStore() = delete;
+  CUploadResumeStore(CUploadResumeStore const &) = delete;
+  CUploadResumeStore(CUploadResumeStore &&) = delete;
+  CUploadResumeStore &operator=(CUploadResumeStore const &) = delete;
+  CUploadResumeStore &operator=(CUploadResumeStore &&) = delete;
+
+  struct entry_t
+  {
+    std::filesystem::path partFile;
+    std::uint64_t offset = 0;
+  };
+
+  std::filesystem::path const directory;
+  std::map<std::string, entry_t> entries;
+  mutable std::mutex mStore;
+
+  /*! @brief      Appends the first bytes of a file to another file.
+   *  @param[in]  destination: The file to append to.
+   *  @param[in]  source: The file to copy from.
+   *  @param[in]  bytes: The number of bytes to copy.
+   *  @throws     RUNTIME_ASSERT if the files cannot be opened or written.
+   */
+  static void append(std::filesystem::path const &destination, std::filesystem::path const &source, std::uint64_t bytes);
+};
+
+#endif // WTEXTENSIONS_UPLOADRESUMESTORE_H
@@ -0,0 +1,215 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                contentStore.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Content-addressed store of uploaded files.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/contentStore.h"
+
+// Standard C++ library header files
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <span>
+#include <vector>
+
+// WtExtensions header files
+#include "include/uploadDigest.h"
+
+CContentStore::CContentStore(std::filesystem::path const &d) : directory(d)
+{
+  std::filesystem::create_directories(directory);
+
+  for (auto const &entry: std::filesystem::directory_iterator(directory))
+  {
+    if (entry.is_regular_file() && entry.path().extension() == ".part")
+    {
+      // A copy into the store that did not complete.
+
+      std::error_code ec;
+      std::filesystem::remove(entry.path(), ec);
+    }
+    else if (entry.is_regular_file())
+    {
+      std::string blobFingerprint = fingerprint(entry.path());
+      if (!blobFingerprint.empty())
+      {
+        byFingerprint.emplace(std::move(blobFingerprint), entry.path().filename().string());
+      }
+    }
+  }
+}
+
+bool CContentStore::contains(std::string const &blobFingerprint) const
+{
+  std::lock_guard lg{mStore};
+  return byFingerprint.contains(blobFingerprint);
+}
+
+void CContentStore::copyIn(std::filesystem::path const &file, std::string const &sha256) noexcept
+{
+  /* The copy is only given the name of the blob once it is complete and verified. The file may be changed or removed while it is
+   * being copied, so any error abandons the copy.
+   */
+
+  try
+  {
+    std::filesystem::path blob = directory / sha256;
+    std::filesystem::path partFile = blob;
+    partFile += ".part";
+    std::error_code ec;
+
+    if (!std::filesystem::exists(blob, ec))
+    {
+      std::ifstream input(file, std::ios::binary);
+      std::ofstream output(partFile, std::ios::binary | std::ios::trunc);
+      std::vector<char> buffer(static_cast<std::size_t>(blockSize));
+      CUploadDigest digest({"SHA256"});
+
+      while (input && output)
+      {
+        input.read(buffer.data(), buffer.size());
+        std::span<char const> data(buffer.data(), input.gcount());
+        digest.update(data);
+        output.write(data.data(), data.size());
+      }
+      output.close();
+
+      if (input.eof() && output && digest.final().at("SHA256") == sha256)
+      {
+        std::filesystem::permissions(partFile, std::filesystem::perms::owner_read, ec);
+        std::filesystem::rename(partFile, blob, ec);
+      }
+      else
+      {
+        ec = std::make_error_code(std::errc::io_error);
+      }
+
+      if (ec)
+      {
+        std::filesystem::remove(partFile, ec);
+      }
+      else
+      {
+        index(sha256);
+      }
+    }
+  }
+  catch(...)
+  {
+    // The file is not added to the store.
+  }
+}
+
+std::string CContentStore::fingerprint(std::filesystem::path const &file)
+{
+  std::string rv;
+  std::error_code ec;
+  std::uint64_t size = std::filesystem::file_size(file, ec);
+  std::ifstream input(file, std::ios::binary);
+
+  if (!ec && input)
+  {
+    // The blocks overlap if the file is smaller than two blocks. The browser slices the file the same way.
+
+    std::vector<char> buffer(static_cast<std::size_t>(std::min(size, blockSize)));
+    CUploadDigest digest({"SHA256"});
+
+    input.read(buffer.data(), buffer.size());
+    digest.update(std::span<char const>(buffer.data(), input.gcount()));
+    input.seekg(size - buffer.size());
+    input.read(buffer.data(), buffer.size());
+    digest.update(std::span<char const>(buffer.data(), input.gcount()));
+    std::string sizeText = std::to_string(size);
+    digest.update(std::span<char const>(sizeText.data(), sizeText.size()));
+
+    if (input)
+    {
+      rv = digest.final().at("SHA256");
+    }
+  }
+  return rv;
+}
+
+void CContentStore::index(std::string const &sha256)
+{
+  // The fingerprint is computed before the lock is taken.
+
+  std::string blobFingerprint = fingerprint(directory / sha256);
+
+  if (!blobFingerprint.empty())
+  {
+    std::lock_guard lg{mStore};
+    byFingerprint.insert_or_assign(std::move(blobFingerprint), sha256);
+  }
+}
+
+void CContentStore::insert(std::filesystem::path const &file, std::string const &sha256)
+{
+  std::filesystem::path blob = directory / sha256;
+  std::error_code ec;
+
+  std::filesystem::create_hard_link(file, blob, ec);
+  if (!ec)
+  {
+    // The permissions belong to the inode, so the file is also made read only.
+
+    std::filesystem::permissions(blob, std::filesystem::perms::owner_read);
+    index(sha256);
+  }
+  else if (ec == std::errc::cross_device_link)
+  {
+    copyPool.submit([this, file, sha256]() { copyIn(file, sha256); });
+  }
+  else if (ec != std::errc::file_exists)
+  {
+    throw std::filesystem::filesystem_error("CContentStore::insert", file, blob, ec);
+  }
+}
+
+bool CContentStore::link(std::string const &sha256, std::string const &blobFingerprint, std::filesystem::path const &destination)
+{
+  bool rv = false;
+
+  // The digest is sent by the browser, so it must not be able to name a file outside the store.
+
+  if (sha256.size() == 64 && std::all_of(sha256.begin(), sha256.end(), [](char c)
+      {
+        return std::isdigit(static_cast<unsigned char>(c)) || (c >= 'a' && c <= 'f');
+      }))
+  {
+    std::filesystem::path blob = directory / sha256;
+
+    if (!blobFingerprint.empty() && fingerprint(blob) == blobFingerprint)
+    {
+      std::error_code ec;
+      std::filesystem::create_hard_link(blob, destination, ec);
+      rv = !ec;
+    }
+  }
+  return rv;
+}
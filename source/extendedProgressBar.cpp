@@ -30,30 +30,41 @@
 
 #include "include/extendedProgressBar.h"
 
-extendedProgressBar::extendedProgressBar(Wt::WApplication &a) : Wt::WProgressBar(), app(&a)
+extendedProgressBar::extendedProgressBar(Wt::WApplication &a) : Wt::WProgressBar(), CPullMode(*this, CUpdateMailbox::instance(a)),
+  app(&a)
 {
-  app->enableUpdates(true);
 }
 
 
+void extendedProgressBar::applyPending()
+{
+  if (rangeChanged.exchange(false))
+  {
+    WProgressBar::setRange(pendingMinimum, pendingMaximum);
+  }
+  if (valueChanged.exchange(false))
+  {
+    WProgressBar::setValue(pendingValue);
+  }
+}
+
 void extendedProgressBar::setValue(double value)
 {
-  Wt::WApplication::UpdateLock uiLock(app);
+  // The value must be stored before the flag is set. applyPending() clears the flag before reading the value.
 
-  if (uiLock)
+  pendingValue = value;
+  if (!valueChanged.exchange(true) && !pullMode)
   {
-    WProgressBar::setValue(value);
-    app->triggerUpdate();
-  };
+    mailbox->post(applyClosure);
+  }
 }
 
 void extendedProgressBar::setRange(double minimum, double maximum)
 {
-  Wt::WApplication::UpdateLock uiLock(app);
-
-  if (uiLock)
+  pendingMinimum = minimum;
+  pendingMaximum = maximum;
+  if (!rangeChanged.exchange(true) && !pullMode)
   {
-    WProgressBar::setRange(minimum, maximum);
-    app->triggerUpdate();
-  };
+    mailbox->post(applyClosure);
+  }
 }
@@ -215,8 +215,6 @@ private:
 
 CFileListWidget::CFileListWidget()
 {
-  model = std::make_shared<CFileListModel>();
-  createUI();
 }
 
 /// @brief      Sets up the UI aspects of the widget.
@@ -225,6 +223,15 @@ CFileListWidget::CFileListWidget()
 
 void CFileListWidget::createUI()
 {
+  std::shared_ptr<CFileListModel> fileListModel = std::make_shared<CFileListModel>();
+
+  for (auto &record: pendingRecords)
+  {
+    fileListModel->setData(record.ID, std::move(record.fileName), std::move(record.fileType));
+  }
+  pendingRecords.clear();
+  model = fileListModel;
+
   setLayoutSizeAware(true);
   setOverflow(Wt::Overflow::Scroll);
 
@@ -243,7 +250,14 @@ void CFileListWidget::createUI()
 
 void CFileListWidget::insert(ID_t ID, std::filesystem::path const &fn, std::string const &ft)
 {
-  std::dynamic_pointer_cast<CFileListModel>(model)->setData(ID, fn, ft);
+  if (model)
+  {
+    std::dynamic_pointer_cast<CFileListModel>(model)->setData(ID, fn, ft);
+  }
+  else
+  {
+    pendingRecords.emplace_back(ID, fn, ft);
+  }
 }
 
 /// @brief      Inserts a new item into the list.
@@ -252,5 +266,24 @@ void CFileListWidget::insert(ID_t ID, std::filesystem::path const &fn, std::stri
 
 void CFileListWidget::insert(ID_t ID, std::filesystem::path &&fn, std::string &&ft)
 {
-  std::dynamic_pointer_cast<CFileListModel>(model)->setData(ID, std::move(fn), std::move(ft));
+  if (model)
+  {
+    std::dynamic_pointer_cast<CFileListModel>(model)->setData(ID, std::move(fn), std::move(ft));
+  }
+  else
+  {
+    pendingRecords.emplace_back(ID, std::move(fn), std::move(ft));
+  }
+}
+
+/// @brief      Creates the UI on the first render.
+/// @param[in]  flags: The render flags.
+
+void CFileListWidget::render(Wt::WFlags<Wt::RenderFlag> flags)
+{
+  if (!model)
+  {
+    createUI();
+  }
+  Wt::WTableView::render(flags);
 }
@@ -0,0 +1,232 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                fileMove.cpp
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Moves files to their destination without copying where possible.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/fileMove.h"
+
+// Standard C++ library header files
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+// Linux header files
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Miscellaneous library header files
+#include <fmt/format.h>
+
+/// Closes the file descriptor when it goes out of scope.
+class CFileDescriptor
+{
+public:
+  explicit CFileDescriptor(int fd) : fileDescriptor(fd) {}
+  ~CFileDescriptor()
+  {
+    if (fileDescriptor >= 0)
+    {
+      close(fileDescriptor);
+    }
+  }
+
+  int get() const noexcept { return fileDescriptor; }
+
+private:
+  CFileDescriptor() = delete;
+  CFileDescriptor(CFileDescriptor const &) = delete;
+  CFileDescriptor(CFileDescriptor &&) = delete;
+  CFileDescriptor &operator=(CFileDescriptor const &) = delete;
+  CFileDescriptor &operator=(CFileDescriptor &&) = delete;
+
+  int fileDescriptor;
+};
+
+/// @brief      Throws a filesystem_error for the current errno.
+/// @param[in]  what: The operation that failed.
+/// @param[in]  source: The source file.
+/// @param[in]  destination: The destination file.
+/// @throws     std::filesystem::filesystem_error
+
+[[noreturn]] static void throwError(char const *what, std::filesystem::path const &source,
+                                    std::filesystem::path const &destination)
+{
+  throw std::filesystem::filesystem_error(what, source, destination, std::error_code(errno, std::generic_category()));
+}
+
+/// @brief      Copies the data between two files in the kernel.
+/// @param[in]  source: The source file.
+/// @param[in]  destination: The destination file.
+/// @param[in]  size: The number of bytes to copy.
+/// @returns    false if the copy failed. errno is set.
+
+static bool copyData(int source, int destination, std::uint64_t size)
+{
+  bool rv = true;
+  bool useCopyFileRange = true;
+  std::uint64_t copied = 0;
+
+  while (rv && copied < size)
+  {
+    ssize_t count;
+
+    if (useCopyFileRange)
+    {
+      count = copy_file_range(source, nullptr, destination, nullptr, size - copied, 0);
+
+      // copy_file_range() is not supported between some file systems. The copy continues with sendfile() from the same offsets.
+
+      if (count < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+      {
+        useCopyFileRange = false;
+        continue;
+      }
+    }
+    else
+    {
+      count = sendfile(destination, source, nullptr, size - copied);
+    }
+
+    if (count > 0)
+    {
+      copied += static_cast<std::uint64_t>(count);
+    }
+    else if (count < 0 && errno == EINTR)
+    {
+      // Interrupted before any data was copied. The call is repeated.
+    }
+    else
+    {
+      // A file that is shorter than its size is an error.
+
+      if (count == 0)
+      {
+        errno = EIO;
+      }
+      rv = false;
+    }
+  }
+  return rv;
+}
+
+/// @brief      Copies a file to another file system.
+/// @param[in]  source: The source file.
+/// @param[in]  destination: The destination path.
+/// @param[in]  tmpFile: true to write the copy to an unnamed file.
+/// @throws     std::filesystem::filesystem_error
+
+static void copyAcross(std::filesystem::path const &source, std::filesystem::path const &destination, bool tmpFile)
+{
+  CFileDescriptor input(open(source.c_str(), O_RDONLY | O_CLOEXEC));
+  struct stat status;
+
+  if (input.get() < 0 || fstat(input.get(), &status) != 0)
+  {
+    throwError("moveFile: open", source, destination);
+  }
+
+  std::filesystem::path directory = destination.has_parent_path() ? destination.parent_path() : std::filesystem::path(".");
+  std::filesystem::path tempFile = fmt::format("{}.{}.part", destination.string(), getpid());
+  int fd = -1;
+
+  if (tmpFile)
+  {
+    fd = open(directory.c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0666);
+  }
+
+  bool unnamed = (fd >= 0);
+  if (!unnamed)
+  {
+    fd = open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  }
+
+  CFileDescriptor output(fd);
+  if (output.get() < 0)
+  {
+    throwError("moveFile: create", source, destination);
+  }
+
+  if (!copyData(input.get(), output.get(), static_cast<std::uint64_t>(status.st_size)))
+  {
+    int error = errno;
+    if (!unnamed)
+    {
+      unlink(tempFile.c_str());
+    }
+    errno = error;
+    throwError("moveFile: copy", source, destination);
+  }
+
+  if (unnamed)
+  {
+    // linkat() does not replace an existing file, so the copy is linked to the temporary name and renamed over the destination.
+
+    std::string procPath = fmt::format("/proc/self/fd/{}", output.get());
+    if (linkat(AT_FDCWD, procPath.c_str(), AT_FDCWD, destination.c_str(), AT_SYMLINK_FOLLOW) != 0)
+    {
+      if (errno == EEXIST && linkat(AT_FDCWD, procPath.c_str(), AT_FDCWD, tempFile.c_str(), AT_SYMLINK_FOLLOW) == 0)
+      {
+        unnamed = false;
+      }
+      else
+      {
+        throwError("moveFile: link", source, destination);
+      }
+    }
+  }
+  if (!unnamed)
+  {
+    std::error_code ec;
+    std::filesystem::rename(tempFile, destination, ec);
+    if (ec)
+    {
+      std::error_code removeError;
+      std::filesystem::remove(tempFile, removeError);
+      throw std::filesystem::filesystem_error("moveFile: rename", source, destination, ec);
+    }
+  }
+}
+
+void moveFile(std::filesystem::path const &source, std::filesystem::path const &destination, bool tmpFile)
+{
+  std::error_code ec;
+
+  std::filesystem::rename(source, destination, ec);
+  if (ec == std::errc::cross_device_link)
+  {
+    copyAcross(source, destination, tmpFile);
+    std::filesystem::remove(source);
+  }
+  else if (ec)
+  {
+    throw std::filesystem::filesystem_error("moveFile: rename", source, destination, ec);
+  }
+}
@@ -0,0 +1,247 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                fileTypeSniffer.cpp
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Determines the type of a file from its first bytes.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/fileTypeSniffer.h"
+
+// Standard C++ library header files
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Linux header files
+#include <fcntl.h>
+#include <unistd.h>
+
+struct signature_t
+{
+  std::string_view magic;         // Bytes at offset 0.
+  std::size_t offset;             // Offset of the second part. (0 = none)
+  std::string_view second;
+  std::string_view type;
+};
+
+using namespace std::literals;
+
+// Sorted by the first byte. Longer signatures must precede shorter signatures with the same prefix.
+
+static constexpr std::array signatures =
+{
+  signature_t{"\x1F\x8B"sv, 0, ""sv, "GZIP archive"sv},
+  signature_t{"%PDF-"sv, 0, ""sv, "PDF document"sv},
+  signature_t{"(\xB5/\xFD"sv, 0, ""sv, "Zstandard archive"sv},
+  signature_t{"7z\xBC\xAF\x27\x1C"sv, 0, ""sv, "7-Zip archive"sv},
+  signature_t{"<?xml"sv, 0, ""sv, "XML document"sv},
+  signature_t{"BM"sv, 6, "\0\0\0\0"sv, "BMP image"sv},
+  signature_t{"BZh"sv, 0, ""sv, "BZIP2 archive"sv},
+  signature_t{"GIF87a"sv, 0, ""sv, "GIF image"sv},
+  signature_t{"GIF89a"sv, 0, ""sv, "GIF image"sv},
+  signature_t{"II*\0"sv, 0, ""sv, "TIFF image"sv},
+  signature_t{"MM\0*"sv, 0, ""sv, "TIFF image"sv},
+  signature_t{"PK\x03\x04"sv, 0, ""sv, "ZIP archive"sv},
+  signature_t{"PK\x05\x06"sv, 0, ""sv, "ZIP archive"sv},
+  signature_t{"RIFF"sv, 8, "WEBP"sv, "WEBP image"sv},
+  signature_t{"Rar!\x1A\x07"sv, 0, ""sv, "RAR archive"sv},
+  signature_t{"\x89PNG\r\n\x1A\n"sv, 0, ""sv, "PNG image"sv},
+  signature_t{"\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1"sv, 0, ""sv, "Microsoft Office document (legacy)"sv},
+  signature_t{"\xFD" "7zXZ\0"sv, 0, ""sv, "XZ archive"sv},
+  signature_t{"\xFF\xD8\xFF"sv, 0, ""sv, "JPEG image"sv},
+};
+
+/// @brief      Builds the index of the first signature for each first byte.
+/// @returns    The index. Entry b is the first signature starting with byte b, entry b + 1 is one past the last.
+
+static constexpr std::array<std::uint8_t, 257> buildIndex()
+{
+  std::array<std::uint8_t, 257> index{};
+  std::size_t signature = 0;
+
+  for (std::size_t byte = 0; byte != 257; byte++)
+  {
+    while (signature != signatures.size() && static_cast<unsigned char>(signatures[signature].magic[0]) < byte)
+    {
+      signature++;
+    }
+    index[byte] = static_cast<std::uint8_t>(signature);
+  }
+  return index;
+}
+
+static constexpr std::array<std::uint8_t, 257> firstByteIndex = buildIndex();
+
+static_assert(std::is_sorted(signatures.begin(), signatures.end(), [](signature_t const &lhs, signature_t const &rhs)
+              {
+                return static_cast<unsigned char>(lhs.magic[0]) < static_cast<unsigned char>(rhs.magic[0]);
+              }), "Signatures must be sorted by their first byte.");
+
+/// @brief      Classifies a ZIP file by the names of its first entries.
+/// @param[in]  data: The start of the file.
+/// @returns    The type of the file.
+
+static std::string_view classifyZip(std::string_view data)
+{
+  std::string_view rv = "ZIP archive"sv;
+
+  if (data.find("mimetype"sv) != std::string_view::npos)
+  {
+    // OpenDocument files start with an uncompressed mimetype entry.
+
+    if (data.find("opendocument.spreadsheet"sv) != std::string_view::npos)
+    {
+      rv = "OpenDocument spreadsheet"sv;
+    }
+    else if (data.find("opendocument.text"sv) != std::string_view::npos)
+    {
+      rv = "OpenDocument text"sv;
+    }
+  }
+  else if (data.find("xl/"sv) != std::string_view::npos)
+  {
+    rv = "XLSX spreadsheet"sv;
+  }
+  else if (data.find("word/"sv) != std::string_view::npos)
+  {
+    rv = "DOCX document"sv;
+  }
+  else if (data.find("ppt/"sv) != std::string_view::npos)
+  {
+    rv = "PPTX presentation"sv;
+  }
+  return rv;
+}
+
+/// @brief      Classifies a file without a signature. Text files are classified as CSV or TSV if the lines have a consistent
+///             number of delimiters.
+/// @param[in]  data: The start of the file.
+/// @param[in]  complete: true if data is the whole file.
+/// @returns    The type of the file.
+
+static std::string_view classifyText(std::string_view data, bool complete)
+{
+  std::string_view rv = "Unknown"sv;
+
+  if (data.starts_with("\xEF\xBB\xBF"sv))
+  {
+    data.remove_prefix(3);
+  }
+
+  bool text = !data.empty() && std::none_of(data.begin(), data.end(), [](char c)
+  {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u == 0 || (u < 0x20 && u != '\t' && u != '\n' && u != '\r' && u != '\f');
+  });
+
+  if (text)
+  {
+    // Only whole lines are examined.
+
+    if (!complete && data.rfind('\n') != std::string_view::npos)
+    {
+      data = data.substr(0, data.rfind('\n') + 1);
+    }
+
+    rv = "Text"sv;
+    for (auto [delimiter, type]: {std::pair{',', "CSV"sv}, std::pair{';', "CSV"sv}, std::pair{'\t', "TSV"sv}})
+    {
+      std::size_t lines = 0;
+      std::ptrdiff_t fields = -1;
+      bool consistent = true;
+      std::string_view remaining = data;
+
+      while (consistent && !remaining.empty())
+      {
+        std::size_t end = std::min(remaining.find('\n'), remaining.size());
+        std::string_view line = remaining.substr(0, end);
+        remaining.remove_prefix(std::min(end + 1, remaining.size()));
+
+        if (!line.empty() && line != "\r"sv)
+        {
+          std::ptrdiff_t count = std::count(line.begin(), line.end(), delimiter);
+          consistent = (count != 0) && (fields == -1 || count == fields);
+          fields = count;
+          lines++;
+        }
+      }
+      if (consistent && lines != 0)
+      {
+        rv = type;
+        break;
+      }
+    }
+  }
+  return rv;
+}
+
+std::string sniffFileType(std::filesystem::path const &file, std::filesystem::path const &)
+{
+  std::string_view rv = "Unknown"sv;
+  std::array<char, 4096> buffer;
+  ssize_t length = -1;
+
+  int fileDescriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor != -1)
+  {
+    length = pread(fileDescriptor, buffer.data(), buffer.size(), 0);
+    close(fileDescriptor);
+  }
+
+  if (length > 0)
+  {
+    std::string_view data(buffer.data(), static_cast<std::size_t>(length));
+    unsigned char firstByte = static_cast<unsigned char>(data[0]);
+    bool matched = false;
+
+    for (std::size_t index = firstByteIndex[firstByte]; !matched && index != firstByteIndex[firstByte + 1]; index++)
+    {
+      signature_t const &signature = signatures[index];
+      if (data.starts_with(signature.magic) &&
+          (signature.offset == 0 || data.substr(std::min(signature.offset, data.size())).starts_with(signature.second)))
+      {
+        rv = signature.type;
+        matched = true;
+      }
+    }
+
+    if (!matched && data.size() > 262 && data.substr(257, 5) == "ustar"sv)
+    {
+      rv = "TAR archive"sv;
+    }
+    else if (!matched)
+    {
+      rv = classifyText(data, static_cast<std::size_t>(length) < buffer.size());
+    }
+    else if (rv == "ZIP archive"sv)
+    {
+      rv = classifyZip(data);
+    }
+  }
+  return std::string(rv);
+}
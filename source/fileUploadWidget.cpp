@@ -31,8 +31,13 @@
 #include "include/fileUploadWidget.h"
 
 // Standard C++ library header files
+#include <charconv>
+#include <exception>
 #include <list>
 #include <map>
+#include <random>
+#include <span>
+#include <string_view>
 
 // Wt++ header files
 #include <Wt/WApplication.h>
@@ -55,6 +60,129 @@
  *           change.
  */
 
+/* Computes the SHA-256 digest of a file in the browser and returns a promise of the hex digest. crypto.subtle cannot digest data
+ * in pieces, so the digest is computed here, one chunk (a multiple of 64 bytes) at a time, and the file is never held in memory.
+ */
+
+static char const *digestScript =
+  "function(file, chunkSize) {"
+    "var K = ["
+      "0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,"
+      "0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,"
+      "0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,"
+      "0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,"
+      "0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,"
+      "0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,"
+      "0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,"
+      "0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2];"
+    "var H = new Int32Array([0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19]);"
+    "var W = new Int32Array(64);"
+    "var block = function(data, offset) {"
+      "var t;"
+      "for (t = 0; t < 16; t++) {"
+        "W[t] = (data[offset + 4 * t] << 24) | (data[offset + 4 * t + 1] << 16) | (data[offset + 4 * t + 2] << 8) | data[offset + 4 * t + 3];"
+      "}"
+      "for (t = 16; t < 64; t++) {"
+        "var x = W[t - 15], y = W[t - 2];"
+        "var s0 = ((x >>> 7) | (x << 25)) ^ ((x >>> 18) | (x << 14)) ^ (x >>> 3);"
+        "var s1 = ((y >>> 17) | (y << 15)) ^ ((y >>> 19) | (y << 13)) ^ (y >>> 10);"
+        "W[t] = W[t - 16] + s0 + W[t - 7] + s1;"
+      "}"
+      "var a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];"
+      "for (t = 0; t < 64; t++) {"
+        "var t1 = (h + (((e >>> 6) | (e << 26)) ^ ((e >>> 11) | (e << 21)) ^ ((e >>> 25) | (e << 7))) + ((e & f) ^ (~e & g)) + K[t] + W[t]) | 0;"
+        "var t2 = ((((a >>> 2) | (a << 30)) ^ ((a >>> 13) | (a << 19)) ^ ((a >>> 22) | (a << 10))) + ((a & b) ^ (a & c) ^ (b & c))) | 0;"
+        "h = g; g = f; f = e; e = (d + t1) | 0; d = c; c = b; b = a; a = (t1 + t2) | 0;"
+      "}"
+      "H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;"
+    "};"
+    "var position = 0;"
+    "var step = function() {"
+      "var end = Math.min(position + chunkSize, file.size);"
+      "return file.slice(position, end).arrayBuffer().then(function(buffer) {"
+        "var data = new Uint8Array(buffer);"
+        "var whole = data.length - data.length % 64;"
+        "for (var offset = 0; offset < whole; offset += 64) { block(data, offset); }"
+        "position = end;"
+        "if (position < file.size) { return step(); }"
+        "var tail = new Uint8Array(data.length - whole < 56 ? 64 : 128);"
+        "var bits = tail.length - 8;"
+        "var high = Math.floor(file.size / 0x20000000), low = (file.size % 0x20000000) * 8;"
+        "tail.set(data.subarray(whole));"
+        "tail[data.length - whole] = 0x80;"
+        "tail[bits] = high >>> 24; tail[bits + 1] = high >>> 16; tail[bits + 2] = high >>> 8; tail[bits + 3] = high;"
+        "tail[bits + 4] = low >>> 24; tail[bits + 5] = low >>> 16; tail[bits + 6] = low >>> 8; tail[bits + 7] = low;"
+        "for (offset = 0; offset < tail.length; offset += 64) { block(tail, offset); }"
+        "return Array.from(H).map(function(v) { return (v >>> 0).toString(16).padStart(8, '0'); }).join('');"
+      "});"
+    "};"
+    "return step();"
+  "}";
+
+/// @brief      Returns a file name that cannot be guessed, for a file in a shared directory.
+/// @returns    "wtx-" and 128 random bits in hex.
+
+static std::string randomFileName()
+{
+  std::random_device randomDevice;
+  return fmt::format("wtx-{:08x}{:08x}{:08x}{:08x}", randomDevice(), randomDevice(), randomDevice(), randomDevice());
+}
+
+/// @brief      Returns the worker pool that the widgets share for type detection. Created when it is first used. The sniffer only
+///             reads the start of each file, so a small pool is enough for all the sessions.
+/// @returns    The pool.
+
+static std::shared_ptr<CThreadPool> sharedTypePool()
+{
+  static std::shared_ptr<CThreadPool> pool = std::make_shared<CThreadPool>(2);
+  return pool;
+}
+
+/// @brief      Sends data of a file to the consumers. Sends begin() first if required.
+/// @param[in]  fileData: The widget's data.
+/// @param[in]  record: The record of the file.
+/// @param[in]  data: The data.
+
+static void streamData(CFileUploadWidget::fileData_t &fileData, CFileUploadWidget::reference record, std::span<char const> data)
+{
+  if (!record.streaming && !fileData.consumers.empty())
+  {
+    record.streaming = true;
+    for (auto &consumer: fileData.consumers)
+    {
+      consumer->begin(record.ID, record.file->clientFileName(), record.file->size());
+    }
+  }
+  if (!data.empty())
+  {
+    for (auto &consumer: fileData.consumers)
+    {
+      consumer->data(record.ID, data);
+    }
+  }
+}
+
+/// @brief      Sends end() to the consumers. A complete file that has no data is sent begin() first.
+/// @param[in]  fileData: The widget's data.
+/// @param[in]  record: The record of the file.
+/// @param[in]  complete: true if the whole file has been sent.
+
+static void endStream(CFileUploadWidget::fileData_t &fileData, CFileUploadWidget::reference record, bool complete)
+{
+  if (complete)
+  {
+    streamData(fileData, record, {});
+  }
+  if (record.streaming)
+  {
+    record.streaming = false;
+    for (auto &consumer: fileData.consumers)
+    {
+      consumer->end(record.ID, complete);
+    }
+  }
+}
+
 class CFileListModel final : public Wt::WAbstractItemModel
 {
 public:
@@ -95,9 +223,19 @@ public:
     shared_lock sl{fileData.mData};
     ID_t ID = ++fileData.lastID;
     fileData.records.emplace_back(ID, fileData.byRow.size(), file, CFileUploadWidget::S_PENDING);
-    fileData.byID.emplace(ID, std::ref(fileData.records.back()));
-    fileData.byPointer.emplace(file, std::ref(fileData.records.back()));
-    fileData.byRow.emplace_back(std::ref(fileData.records.back()));
+    reference record = fileData.records.back();
+    fileData.byID.emplace(ID, std::ref(record));
+    fileData.byPointer.emplace(file, std::ref(record));
+    fileData.byRow.emplace_back(std::ref(record));
+
+    // Each file has its own connections, so any number of files can be in flight.
+
+    record.dataReceivedConnection = file->dataReceived().connect([this, file](std::uint64_t num, std::uint64_t denom)
+    {
+      dataReceived(file, num, denom);
+    });
+    record.uploadCompleteConnection = file->uploaded().connect([this, file]() { uploadFinished(file); });
+
     Wt::WModelIndex modelIndex;
     rowsInserted().emit(modelIndex, fileData.byRow.size() - 1, fileData.byRow.size() - 1);
     return ID;
@@ -149,37 +287,54 @@ public:
     }
   }
 
-  void setCurrentFile(Wt::WFileDropWidget::File *cf)
+  /*! @brief      Marks a file as uploading.
+   *  @param[in]  file: The file that is starting to upload.
+   *  @throws
+   */
+  void uploadStarting(Wt::WFileDropWidget::File *file)
   {
     /* This function is called from the GUI thread. */
 
     shared_lock sl{fileData.mData};
-    if (fileData.currentFile && fileData.byPointer.contains(fileData.currentFile))
+    if (fileData.byPointer.contains(file))
     {
-      reference temp = fileData.byPointer.at(fileData.currentFile).get();
+      reference record = fileData.byPointer.at(file).get();
       sl.unlock();
-      temp.dataReceivedConnection.disconnect();
-      temp.uploadCompleteConnection.disconnect();
-      temp.status = CFileUploadWidget::S_COMPLETE;
-      Wt::WModelIndex modelIndex = createIndex(fileData.byPointer.at(fileData.currentFile).get().row, 1,  nullptr);
-      dataChanged().emit(modelIndex, modelIndex);
+      if (record.status == CFileUploadWidget::S_PENDING)
+      {
+        record.status = CFileUploadWidget::S_UPLOADING;
+        fileData.uploadsInFlight++;
+        Wt::WModelIndex modelIndex = createIndex(record.row, 1,  nullptr);
+        dataChanged().emit(modelIndex, modelIndex);
+      }
     }
+  }
 
-    fileData.currentFile = cf;    // May be setting to nullptr.
-    if (!sl)
-    {
-      sl.lock();
-    }
-    if (fileData.currentFile && fileData.byPointer.contains(fileData.currentFile))
+  /*! @brief      Updates the status column of a file.
+   *  @param[in]  record: The record of the file.
+   */
+  void statusChanged(const_reference record)
+  {
+    Wt::WModelIndex modelIndex = createIndex(record.row, 1,  nullptr);
+    dataChanged().emit(modelIndex, modelIndex);
+  }
+
+  /*! @brief      Completes a file whose upload was skipped.
+   *  @param[in]  record: The record of the file.
+   */
+  void uploadSkipped(reference record)
+  {
+    /* This is called by GUI thread. */
+
+    record.dataReceivedConnection.disconnect();
+    record.uploadCompleteConnection.disconnect();
+    if (record.status == CFileUploadWidget::S_UPLOADING)
     {
-      reference temp = fileData.byPointer.at(fileData.currentFile).get();
-      sl.unlock();
-      temp.dataReceivedConnection = fileData.currentFile->dataReceived().connect(this, &CFileListModel::dataReceived);
-      temp.uploadCompleteConnection = fileData.currentFile->uploaded().connect(this, &CFileListModel::uploadFinished);
-      temp.status = CFileUploadWidget::S_UPLOADING;
-      Wt::WModelIndex modelIndex = createIndex(fileData.byPointer.at(fileData.currentFile).get().row, 1,  nullptr);
-      dataChanged().emit(modelIndex, modelIndex);
+      fileData.uploadsInFlight--;
     }
+    record.status = CFileUploadWidget::S_COMPLETE;
+    Wt::WModelIndex modelIndex = createIndex(record.row, 1,  nullptr);
+    dataChanged().emit(modelIndex, modelIndex);
   }
 
 protected:
@@ -314,21 +469,98 @@ protected:
 
   virtual Wt::WFlags<Wt::ItemFlag> flags(const Wt::WModelIndex &index) const override { return Wt::WFlags<Wt::ItemFlag>(); }
 
-  void dataReceived(std::uint64_t num, std::uint64_t denom)
+  /*! @brief      Processes the data that has been appended to the spool file. Compressed data is decompressed and the data is
+   *              added to the digests.
+   *  @param[in]  file: The file.
+   *  @param[in]  record: The record of the file.
+   */
+  void readReceived(Wt::WFileDropWidget::File *file, reference record)
+  {
+    std::string spoolFile = file->uploadedFile().spoolFileName();
+
+    // The spool file is only known once the first chunk has been received.
+
+    if (!record.spoolReader && !spoolFile.empty())
+    {
+      record.spoolReader = std::make_unique<CSpoolReader>(spoolFile);
+      if (record.compressed)
+      {
+        record.inflater = std::make_unique<CStreamInflater>(spoolFile + ".inflated", [this, &record](std::span<char const> data)
+        {
+          record.bytesInflated += data.size();
+          if (record.digest)
+          {
+            record.digest->update(data);
+          }
+          streamData(fileData, record, data);
+        });
+      }
+    }
+    if (record.spoolReader)
+    {
+      record.spoolReader->read([this, &record](std::span<char const> data)
+      {
+        record.bytesReceived += data.size();
+        if (record.inflater)
+        {
+          if (!record.inflater->failed())
+          {
+            record.inflater->write(data);
+          }
+        }
+        else
+        {
+          if (record.digest)
+          {
+            record.digest->update(data);
+          }
+
+          // The spool file of a resumed upload does not start at the start of the file.
+
+          if (record.resumeOffset == 0)
+          {
+            streamData(fileData, record, data);
+          }
+        }
+      });
+    }
+  }
+
+  void dataReceived(Wt::WFileDropWidget::File *file, std::uint64_t num, std::uint64_t denom)
   {
     /* This is called by GUI thread. */
 
     shared_lock sl{fileData.mData};
-    if (fileData.currentFile && fileData.byPointer.contains(fileData.currentFile))
+    if (fileData.byPointer.contains(file))
     {
-      if (fileData.byPointer.at(fileData.currentFile).get().progressBar)
+      reference record = fileData.byPointer.at(file).get();
+      sl.unlock();
+
+      // Data can arrive before the upload starting signal has been processed.
+
+      uploadStarting(file);
+      if (record.compressed || record.digest || !fileData.consumers.empty())
+      {
+        readReceived(file, record);
+      }
+      if (record.compressed && file->size() != 0)
+      {
+        /* The browser reports the original size, but the bytes sent are compressed. The progress is measured by the decompressed
+         * data against the original size. If the data does not decompress (the browser did not compress the file), the data
+         * received is the original data.
+         */
+
+        num = (record.inflater && !record.inflater->failed()) ? record.bytesInflated : record.bytesReceived;
+        denom = file->size();
+      }
+      if (record.progressBar)
       {
         double temp = static_cast<double>(num)/static_cast<double>(denom) * 100;
 
-        if ( ((temp - fileData.byPointer.at(fileData.currentFile).get().lastUpdate)) >= 10)
+        if ( ((temp - record.lastUpdate)) >= 10)
         {
-          fileData.byPointer.at(fileData.currentFile).get().progressBar->setValue(temp);
-          fileData.byPointer.at(fileData.currentFile).get().lastUpdate = temp;
+          record.progressBar->setValue(temp);
+          record.lastUpdate = temp;
         }
       }
     }
@@ -339,12 +571,108 @@ protected:
     }
   }
 
-  void uploadFinished()
+  void uploadFinished(Wt::WFileDropWidget::File *file)
   {
+    /* This is called by GUI thread. */
+
     shared_lock sl{fileData.mData};
-    if (fileData.currentFile && fileData.byPointer.contains(fileData.currentFile))
+    if (fileData.byPointer.contains(file))
     {
-      setCurrentFile(nullptr);
+      reference record = fileData.byPointer.at(file).get();
+      sl.unlock();
+      record.dataReceivedConnection.disconnect();
+      record.uploadCompleteConnection.disconnect();
+      if (record.status == CFileUploadWidget::S_UPLOADING)
+      {
+        fileData.uploadsInFlight--;
+      }
+      if (record.compressed || record.digest || !fileData.consumers.empty())
+      {
+        readReceived(file, record);
+      }
+
+      // The digests and the streamed data are only valid if the data read was the whole file.
+
+      bool dataValid = (record.resumeOffset == 0);
+      if (record.compressed)
+      {
+        // If the browser did not compress the file, the data does not decompress to the original size and the spool file is
+        // kept.
+
+        if (record.inflater)
+        {
+          std::filesystem::path spoolFile = file->uploadedFile().spoolFileName();
+          std::filesystem::path inflatedFile = spoolFile.string() + ".inflated";
+          std::error_code ec;
+
+          if (record.inflater->finish() && record.bytesInflated == file->size())
+          {
+            std::filesystem::rename(inflatedFile, spoolFile, ec);
+          }
+          else
+          {
+            std::filesystem::remove(inflatedFile, ec);
+            dataValid = false;
+          }
+          record.inflater.reset();
+        }
+        else
+        {
+          dataValid = false;
+        }
+      }
+      record.spoolReader.reset();
+      if (record.resumeOffset != 0)
+      {
+        // The spool only holds the chunks after the resume offset.
+
+        fileData.resumeStore->complete(record.resumeKey, file->uploadedFile().spoolFileName());
+      }
+      if (!dataValid && (record.digest || !fileData.consumers.empty()))
+      {
+        // The file is read again from the spool file. Anything already sent to the consumers is discarded.
+
+        endStream(fileData, record, false);
+        if (record.digest)
+        {
+          record.digest = std::make_unique<CUploadDigest>(fileData.digestNames);
+        }
+        CSpoolReader spoolReader(file->uploadedFile().spoolFileName());
+        spoolReader.read([this, &record](std::span<char const> data)
+        {
+          if (record.digest)
+          {
+            record.digest->update(data);
+          }
+          streamData(fileData, record, data);
+        });
+      }
+      endStream(fileData, record, true);
+      if (record.digest)
+      {
+        unique_lock ul{record.mRecord};
+        record.digests = record.digest->final();
+        ul.unlock();
+        record.digest.reset();
+      }
+      if (fileData.contentStore && record.digests.contains("SHA256"))
+      {
+        try
+        {
+          fileData.contentStore->insert(file->uploadedFile().spoolFileName(), record.digests.at("SHA256"));
+        }
+        catch(std::filesystem::filesystem_error const &)
+        {
+          // The file is not deduplicated. The upload is still complete.
+        }
+      }
+      record.status = CFileUploadWidget::S_COMPLETE;
+      Wt::WModelIndex modelIndex = createIndex(record.row, 1,  nullptr);
+      dataChanged().emit(modelIndex, modelIndex);
+      if (fileData.uploadCompleted)
+      {
+        fileData.uploadCompleted(record);
+      }
     }
     else
     {
@@ -387,9 +715,13 @@ protected:
       {
         if (data->textEditStatus == nullptr)
         {
-          rv = std::make_unique<Wt::WText>("Pending");
+          rv = std::make_unique<Wt::WText>(data->pendingText);
           data->textEditStatus = dynamic_cast<Wt::WText *>(rv.get());
         }
+        else
+        {
+          data->textEditStatus->setText(data->pendingText);
+        }
         break;
       }
       case CFileUploadWidget::S_UPLOADING:
@@ -439,78 +771,1023 @@ private:
 
 /**********************************************************************************************************************************/
 
-CFileUploadWidget::CFileUploadWidget(Wt::WApplication &a) : Wt::WFileDropWidget(), application(a)
+CFileUploadWidget::CFileUploadWidget(Wt::WApplication &a) : Wt::WFileDropWidget(), CPullMode(*this, CUpdateMailbox::instance(a)),
+  application(a), fingerprintSignal(this, "fingerprint"), contentDigestSignal(this, "contentDigest"),
+  dropKeysSignal(this, "dropKeys")
 {
+  drop().connect(this, &CFileUploadWidget::filesDropped);
+  newUpload().connect(this, &CFileUploadWidget::fileUploadStarting);
+  uploadFailed().connect(this, &CFileUploadWidget::fileUploadFailed);
+  fingerprintSignal.connect(this, &CFileUploadWidget::fingerprintReceived);
+  contentDigestSignal.connect(this, &CFileUploadWidget::contentDigestReceived);
+  dropKeysSignal.connect(this, &CFileUploadWidget::dropKeysReceived);
+
+  // The modification time of each file is sent before the drop (capture phase), so that it is part of the file's key.
+
+  doJavaScript(fmt::format(
+    "{0}.addEventListener('drop', function(event) {{"
+      "var files = event.dataTransfer ? event.dataTransfer.files : [];"
+      "var keys = Array.prototype.map.call(files, function(file) {{ return file.size + ':' + (file.lastModified || 0); }});"
+      "{1};"
+    "}}, true);", jsRef(), dropKeysSignal.createCall({"keys.join(',')"})));
+  fileData.uploadCompleted = [this](reference record)
+  {
+    detectFileType(record.ID, record.file->uploadedFile().spoolFileName(), record.file->clientFileName());
+    processFile(record.ID, record.file->uploadedFile().spoolFileName(), record.file->clientFileName());
+  };
+
+  // The model keeps the record bookkeeping, so it is created with the widget. Only the view waits for the first render.
+
   model = std::make_shared<CFileListModel>(fileData);
-  createUI();
+}
+
+CFileUploadWidget::~CFileUploadWidget()
+{
+  // The files are removed below, so the type detection and processing jobs must not run after this.
+
+  {
+    std::unique_lock ul{detectedTypes->mTypes};
+    detectedTypes->cancelled = true;
+    detectedTypes->cvRunning.wait(ul, [this]() { return detectedTypes->running == 0; });
+  }
+  {
+    std::lock_guard lg{processingStatus->mStatus};
+    processingStatus->cancelled = true;
+  }
+  processPool.reset();
+
+  for (auto &record: fileData.records)
+  {
+    record.dataReceivedConnection.disconnect();
+    record.uploadCompleteConnection.disconnect();
+    if (record.status == S_UPLOADING && fileData.resumeStore && !record.compressed)
+    {
+      fileData.resumeStore->save(record.resumeKey, record.file->uploadedFile().spoolFileName(), fileData.chunkSize);
+    }
+    discardInflater(record);
+    endStream(fileData, record, false);
+    releaseAdmission(record);
+    if (!record.linkedFile.empty())
+    {
+      std::error_code ec;
+      std::filesystem::remove(record.linkedFile, ec);
+    }
+  }
+}
+
+void CFileUploadWidget::addConsumer(std::shared_ptr<CUploadConsumer> consumer)
+{
+  RUNTIME_ASSERT(consumer != nullptr, "CFileUploadWidget::addConsumer: Consumer cannot be nullptr.");
+
+  fileData.consumers.push_back(std::move(consumer));
+}
+
+void CFileUploadWidget::admitFiles(std::vector<std::string> const &keys)
+{
+  /* Once admission is enabled, the first chunk of each file waits in the gate until the file has been admitted. The count for
+   * each key allows for several drops of the same file.
+   */
+
+  if (fileData.chunkSize != 0)
+  {
+    std::string admitted;
+    for (auto const &key: keys)
+    {
+      admitted += fmt::format("{}{}", admitted.empty() ? "" : ",", Wt::WString(key).jsStringLiteral());
+    }
+
+    doJavaScript(fmt::format(
+      "(function(gate) {{"
+        "gate.admission = true;"
+        "[{0}].forEach(function(key) {{ gate.admitted[key] = (gate.admitted[key] || 0) + 1; }});"
+        "gate.waiting.splice(0).forEach(function(check) {{ check(); }});"
+      "}})({1});", admitted, gateRef()));
+  }
+}
+
+void CFileUploadWidget::addFilterStage(std::string const &stage)
+{
+  filterStages.push_back(stage);
+  updateFilter();
 }
 
   void CFileUploadWidget::clearData() noexcept
   {
     unique_lock ul{fileData.mData};
 
+    for (auto &record: fileData.records)
+    {
+      record.dataReceivedConnection.disconnect();
+      record.uploadCompleteConnection.disconnect();
+      endStream(fileData, record, false);
+      releaseAdmission(record);
+      if (!record.linkedFile.empty())
+      {
+        std::error_code ec;
+        std::filesystem::remove(record.linkedFile, ec);
+      }
+    }
     fileData.files.clear();
     fileData.records.clear();
     fileData.byID.clear();
     fileData.byPointer.clear();
     fileData.byRow.clear();
-    fileData.currentFile = nullptr;
+    fileData.uploadsInFlight = 0;
     fileData.lastID = 0;
     model->clearData();
   }
 
-void CFileUploadWidget::createUI()
+void CFileUploadWidget::applyPending()
 {
-  setLayoutSizeAware(true);
-  setOverflow(Wt::Overflow::Scroll);
+  std::vector<std::pair<ID_t, std::string>> completedText;
 
-  tableView = addWidget(std::make_unique<Wt::WTableView>());
-  tableView->setModel(model);
-  tableView->setColumnResizeEnabled(true);
-  tableView->setColumnAlignment(0, Wt::AlignmentFlag::Center);
-  tableView->setHeaderAlignment(0, Wt::AlignmentFlag::Center);
-  tableView->setAlternatingRowColors(true);
-  tableView->setSelectionMode(Wt::SelectionMode::Single);
-  tableView->setEditTriggers(Wt::EditTrigger::None);
-  tableView->setItemDelegateForColumn(1, std::make_shared<CFileListDelegate>());
+  {
+    std::lock_guard lg{mPending};
+    std::swap(completedText, pendingCompletedText);
+  }
 
-  drop().connect(this, &CFileUploadWidget::filesDropped);
-  newUpload().connect(this, &CFileUploadWidget::fileUploadStarting);
+  for (auto &[fileID, ct]: completedText)
+  {
+    model->setCompletedText(fileID, std::move(ct));
+  }
+
+  std::vector<std::pair<ID_t, std::string>> types;
+
+  {
+    std::lock_guard lg{detectedTypes->mTypes};
+    std::swap(types, detectedTypes->types);
+  }
+
+  for (auto &[fileID, fileType]: types)
+  {
+    shared_lock sl{fileData.mData};
+    if (fileData.byID.contains(fileID))
+    {
+      reference record = fileData.byID.at(fileID).get();
+      sl.unlock();
+      record.fileType = fileType;
+
+      // The processing status takes the place of the type.
+
+      if (record.processStatus == P_NONE)
+      {
+        model->setCompletedText(fileID, std::move(fileType));
+      }
+    }
+  }
+
+  std::vector<std::tuple<ID_t, processStatus_e, std::string>> changes;
+
+  {
+    std::lock_guard lg{processingStatus->mStatus};
+    std::swap(changes, processingStatus->changes);
+  }
+
+  for (auto &[fileID, processStatus, text]: changes)
+  {
+    shared_lock sl{fileData.mData};
+    if (fileData.byID.contains(fileID))
+    {
+      fileData.byID.at(fileID).get().processStatus = processStatus;
+      sl.unlock();
+      model->setCompletedText(fileID, std::move(text));
+    }
+  }
+  updatePause();
 }
 
-void CFileUploadWidget::fileUploadStarting(Wt::WFileDropWidget::File *file)
+void CFileUploadWidget::chunkSize(std::uint64_t cs)
 {
-  /* This function is called from the GUI thread. */
+  fileData.chunkSize = cs;
+  updateFilter();
+}
 
-  model->setCurrentFile(file);
+void CFileUploadWidget::compression(bool enable)
+{
+  fileData.compression = enable;
+  updateFilter();
 }
 
-void CFileUploadWidget::filesDropped(std::vector<Wt::WFileDropWidget::File*> const& files)
+std::string CFileUploadWidget::digest(ID_t fileID, std::string const &digestName) const
 {
-  for (auto const &file: files)
+  std::string rv;
+
+  shared_lock sl{fileData.mData};
+  if (fileData.byID.contains(fileID))
   {
-    ID_t ID = model->insert_back(file);
-    fileUploadSignal.emit(ID, file);
+    reference record = fileData.byID.at(fileID).get();
+    shared_lock rl{record.mRecord};
+    if (record.digests.contains(digestName))
+    {
+      rv = record.digests.at(digestName);
+    }
   }
-
-  // If the maximum number of files has been met or exceeded, don't allow any more drops.
-  if (uploads().size() >= maxFiles_)
+  else
   {
-    setAcceptDrops(false);
+    CODE_ERROR();
+    // Does not return.
   }
-
+  return rv;
 }
 
-void CFileUploadWidget::setCompletedText(ID_t fileID, std::string const &ct)
+void CFileUploadWidget::contentStore(std::shared_ptr<CContentStore> cs)
 {
-  Wt::WApplication::UpdateLock uiLock(&application);
+  unique_lock ul{fileData.mData};
 
-  if (uiLock)
+  fileData.contentStore = std::move(cs);
+  if (fileData.contentStore &&
+      std::find(fileData.digestNames.begin(), fileData.digestNames.end(), "SHA256") == fileData.digestNames.end())
   {
-    model->setCompletedText(fileID, ct);
-  };
-  application.triggerUpdate();
-}
+    fileData.digestNames.emplace_back("SHA256");
+  }
+  ul.unlock();
+
+  if (fileData.contentStore)
+  {
+    static constexpr std::uint64_t hashSize = 16 * CContentStore::blockSize;
 
+    /* The fingerprint is computed as the files are dropped. The slices must match CContentStore::fingerprint(). The files are
+     * kept until the server asks for the digest of the whole file (wtxHash), which is only computed if the store may hold the
+     * content. The file is read in chunks of the hash size.
+     */
 
+    doJavaScript(fmt::format(
+      "(function(el) {{"
+        "if (!window.crypto || !crypto.subtle) {{ return; }}"
+        "var hex = function(digest) {{"
+          "return Array.from(new Uint8Array(digest)).map(function(b) {{ return b.toString(16).padStart(2, '0'); }}).join('');"
+        "}};"
+        "var digestFile = {4};"
+        "el.wtxFiles = {{}};"
+        "el.wtxHash = function(key, wanted) {{"
+          "var file = el.wtxFiles[key];"
+          "delete el.wtxFiles[key];"
+          "if (file && wanted) {{"
+            "digestFile(file, {5}).then(function(sha256) {{ {3}; }});"
+          "}}"
+        "}};"
+        "el.addEventListener('drop', function(event) {{"
+          "var files = event.dataTransfer ? event.dataTransfer.files : [];"
+          "Array.prototype.forEach.call(files, function(file) {{"
+            "var key = file.name + ':' + file.size + ':' + (file.lastModified || 0);"
+            "var first = file.slice(0, Math.min({0}, file.size));"
+            "var last = file.slice(Math.max(0, file.size - {0}));"
+            "el.wtxFiles[key] = file;"
+            "new Blob([first, last, String(file.size)]).arrayBuffer()"
+              ".then(function(buffer) {{ return crypto.subtle.digest('SHA-256', buffer); }})"
+              ".then(function(digest) {{ var fp = hex(digest); {1}; }});"
+          "}});"
+        "}}, true);"
+      "}})({2});", CContentStore::blockSize, fingerprintSignal.createCall({"key", "fp"}), jsRef(),
+      contentDigestSignal.createCall({"key", "sha256"}), digestScript, hashSize));
+  }
+}
 
+void CFileUploadWidget::contentDigestReceived(std::string key, std::string sha256)
+{
+  /* Only the digests that were requested are accepted, and the blob must have the fingerprint of the file, so a browser cannot take
+   * content from the store by sending the digest of a file that was not dropped.
+   */
+
+  if (!offeredFingerprints.contains(key))
+  {
+    return;
+  }
+  std::string fingerprint = std::move(offeredFingerprints.at(key));
+  offeredFingerprints.erase(key);
+
+  shared_lock sl{fileData.mData};
+  if (fileData.contentStore)
+  {
+    // The first file with the key that has not completed is linked.
+
+    auto iter = std::find_if(fileData.records.begin(), fileData.records.end(), [&key](const_reference record)
+    {
+      return record.status != S_COMPLETE && record.linkedFile.empty() && record.fileKey == key;
+    });
+
+    if (iter != fileData.records.end())
+    {
+      reference record = *iter;
+      std::filesystem::path directory = fileData.spoolDirectory;
+      sl.unlock();
+
+      if (directory.empty())
+      {
+        // Wt has not created the spool file if the first chunk has not been received. Wt spools to the temporary directory.
+
+        std::filesystem::path spoolFile = record.file->uploadedFile().spoolFileName();
+        directory = spoolFile.empty() ? std::filesystem::temp_directory_path() : spoolFile.parent_path();
+      }
+      std::filesystem::path linkedFile = directory / randomFileName();
+
+      if (fileData.contentStore->link(sha256, fingerprint, linkedFile))
+      {
+        record.linkedFile = linkedFile;
+        cancelUpload(record.file);
+        releaseAdmission(record);
+        discardInflater(record);
+        record.digest.reset();
+        model->uploadSkipped(record);
+        if (std::find(fileData.digestNames.begin(), fileData.digestNames.end(), "SHA256") != fileData.digestNames.end())
+        {
+          unique_lock ul{record.mRecord};
+          record.digests.emplace("SHA256", sha256);
+        }
+        endStream(fileData, record, false);
+        CSpoolReader linkedReader(linkedFile);
+        linkedReader.read([this, &record](std::span<char const> data) { streamData(fileData, record, data); });
+        endStream(fileData, record, true);
+        fileLinkedSignal.emit(record.ID, linkedFile);
+        detectFileType(record.ID, linkedFile, record.file->clientFileName());
+        processFile(record.ID, linkedFile, record.file->clientFileName());
+      }
+    }
+  }
+}
+
+void CFileUploadWidget::createUI()
+{
+  setLayoutSizeAware(true);
+  setOverflow(Wt::Overflow::Scroll);
+
+  tableView = addWidget(std::make_unique<Wt::WTableView>());
+  tableView->setModel(model);
+  tableView->setColumnResizeEnabled(true);
+  tableView->setColumnAlignment(0, Wt::AlignmentFlag::Center);
+  tableView->setHeaderAlignment(0, Wt::AlignmentFlag::Center);
+  tableView->setAlternatingRowColors(true);
+  tableView->setSelectionMode(Wt::SelectionMode::Single);
+  tableView->setEditTriggers(Wt::EditTrigger::None);
+  tableView->setItemDelegateForColumn(1, std::make_shared<CFileListDelegate>());
+}
+
+void CFileUploadWidget::fileUploadStarting(Wt::WFileDropWidget::File *file)
+{
+  /* This function is called from the GUI thread. */
+
+  model->uploadStarting(file);
+}
+
+void CFileUploadWidget::discardInflater(reference record)
+{
+  if (record.inflater)
+  {
+    std::error_code ec;
+    record.inflater->finish();
+    std::filesystem::remove(record.file->uploadedFile().spoolFileName() + ".inflated", ec);
+    record.inflater.reset();
+    record.spoolReader.reset();
+  }
+}
+
+void CFileUploadWidget::fileAdmitted(CUploadGovernor::ticket_t ticket)
+{
+  /* This function is called from the GUI thread. The file may have been removed or linked while it was waiting. */
+
+  shared_lock sl{fileData.mData};
+  auto iter = std::find_if(fileData.records.begin(), fileData.records.end(), [ticket](const_reference record)
+  {
+    return record.admissionTicket == ticket;
+  });
+
+  if (iter != fileData.records.end())
+  {
+    reference record = *iter;
+    sl.unlock();
+
+    record.pendingText = "Pending";
+    if (record.status == S_PENDING)
+    {
+      model->statusChanged(record);
+    }
+    admitFiles({record.fileKey});
+  }
+}
+
+void CFileUploadWidget::fileTypeDetection(fileType_f ft, std::shared_ptr<CThreadPool> pool)
+{
+  fileTypeFunction = ft;
+  if (pool)
+  {
+    typePool = std::move(pool);
+  }
+}
+
+void CFileUploadWidget::fingerprintReceived(std::string key, std::string fingerprint)
+{
+  /* The fingerprint does not cover the whole file, so it only shows that the store may hold the content. The digest of the whole
+   * file is then requested, as long as a file with the key is still uploading.
+   */
+
+  shared_lock sl{fileData.mData};
+  if (fileData.contentStore)
+  {
+    bool wanted = fileData.contentStore->contains(fingerprint) &&
+                  std::any_of(fileData.records.begin(), fileData.records.end(), [&key](const_reference record)
+    {
+      return record.status != S_COMPLETE && record.linkedFile.empty() && record.fileKey == key;
+    });
+    sl.unlock();
+
+    if (wanted)
+    {
+      offeredFingerprints.insert_or_assign(key, fingerprint);
+    }
+    doJavaScript(fmt::format("{}.wtxHash({}, {});", jsRef(), Wt::WString(key).jsStringLiteral(), wanted ? "true" : "false"));
+  }
+}
+
+void CFileUploadWidget::fileUploadFailed(Wt::WFileDropWidget::File *file)
+{
+  shared_lock sl{fileData.mData};
+  if (fileData.byPointer.contains(file))
+  {
+    reference record = fileData.byPointer.at(file).get();
+    sl.unlock();
+    if (fileData.resumeStore && !record.compressed)
+    {
+      fileData.resumeStore->save(record.resumeKey, file->uploadedFile().spoolFileName(), fileData.chunkSize);
+    }
+    discardInflater(record);
+    endStream(fileData, record, false);
+    releaseAdmission(record);
+  }
+}
+
+void CFileUploadWidget::detectFileType(ID_t fileID, std::filesystem::path const &filePath,
+                                       std::filesystem::path const &clientFileName)
+{
+  /* This function is called from the GUI thread. In push mode the first result of a batch posts the apply closure to the mailbox,
+   * and later results are applied by the same update. In pull mode the results are applied by the timer.
+   */
+
+  if (fileTypeFunction)
+  {
+    bool pushMode = !pullMode;
+
+    if (!typePool)
+    {
+      typePool = sharedTypePool();
+    }
+    typePool->submit([fileTypeFunction = fileTypeFunction, detectedTypes = detectedTypes, mailbox = mailbox,
+                      publish = applyClosure, pushMode, fileID, filePath, clientFileName]()
+    {
+      {
+        std::lock_guard lg{detectedTypes->mTypes};
+        if (detectedTypes->cancelled)
+        {
+          return;
+        }
+        detectedTypes->running++;
+      }
+
+      // The pool's tasks must not throw, and the running count must always be decremented.
+
+      std::string fileType;
+      try
+      {
+        fileType = fileTypeFunction(filePath, clientFileName);
+      }
+      catch(std::exception const &e)
+      {
+        fileType = fmt::format("Type detection failed: {}", e.what());
+      }
+      catch(...)
+      {
+        fileType = "Type detection failed";
+      }
+
+      bool wasEmpty;
+
+      {
+        std::lock_guard lg{detectedTypes->mTypes};
+        wasEmpty = detectedTypes->types.empty();
+        detectedTypes->types.emplace_back(fileID, std::move(fileType));
+      }
+
+      if (wasEmpty && pushMode)
+      {
+        try
+        {
+          mailbox->post(publish);
+        }
+        catch(...)
+        {
+          // The type is applied by the next update.
+        }
+      }
+
+      {
+        std::lock_guard lg{detectedTypes->mTypes};
+        detectedTypes->running--;
+      }
+      detectedTypes->cvRunning.notify_all();
+    });
+  }
+}
+
+void CFileUploadWidget::dropKeysReceived(std::string keys)
+{
+  droppedModified.clear();
+
+  std::size_t position = 0;
+  while (position < keys.size())
+  {
+    std::size_t end = std::min(keys.find(',', position), keys.size());
+    std::string_view key(keys.data() + position, end - position);
+    std::size_t separator = key.find(':');
+    std::uint64_t size = 0;
+    std::uint64_t lastModified = 0;
+
+    if (separator != std::string_view::npos &&
+        std::from_chars(key.data(), key.data() + separator, size).ec == std::errc() &&
+        std::from_chars(key.data() + separator + 1, key.data() + key.size(), lastModified).ec == std::errc())
+    {
+      droppedModified.emplace_back(size, lastModified);
+    }
+    position = end + 1;
+  }
+}
+
+void CFileUploadWidget::digests(std::vector<std::string> const &dn)
+{
+  unique_lock ul{fileData.mData};
+  fileData.digestNames = dn;
+}
+
+void CFileUploadWidget::filesDropped(std::vector<Wt::WFileDropWidget::File*> const& files)
+{
+  bool resuming = false;
+  std::vector<std::string> admittedKeys;
+  CUploadGovernor::admitted_f admitted;
+
+  if (governor)
+  {
+    /* The governor calls the function from the thread that released the space, which may be this session's GUI thread with the
+     * data locked. The admission is always posted to the session (not through the mailbox, which calls GUI thread closures
+     * immediately), so it is applied after the release has completed.
+     */
+
+    std::function<void(CUploadGovernor::ticket_t)> publish = bindSafe([this](CUploadGovernor::ticket_t ticket)
+    {
+      fileAdmitted(ticket);
+      application.triggerUpdate();
+    });
+    admitted = [sessionID = application.sessionId(), publish](CUploadGovernor::ticket_t ticket)
+    {
+      Wt::WServer::instance()->post(sessionID, [publish, ticket]() { publish(ticket); });
+    };
+  }
+
+  for (auto const &file: files)
+  {
+    ID_t ID = model->insert_back(file);
+
+    shared_lock sl{fileData.mData};
+    reference record = fileData.byID.at(ID).get();
+    sl.unlock();
+
+    // The modification times arrive in drop order. Each file takes the first one recorded for a file of its size.
+
+    std::uint64_t lastModified = 0;
+    auto modified = std::find_if(droppedModified.begin(), droppedModified.end(),
+                                 [&file](auto const &dm) { return dm.first == file->size(); });
+    if (modified != droppedModified.end())
+    {
+      lastModified = modified->second;
+      droppedModified.erase(modified);
+    }
+    record.fileKey = CUploadResumeStore::key(file->clientFileName(), file->size(), lastModified);
+
+    record.compressed = fileData.compression && fileData.chunkSize != 0;
+    if (!fileData.digestNames.empty())
+    {
+      record.digest = std::make_unique<CUploadDigest>(fileData.digestNames);
+    }
+    if (fileData.resumeStore && fileData.chunkSize != 0 && !record.compressed)
+    {
+      record.resumeKey = record.fileKey;
+      record.resumeOffset = fileData.resumeStore->offset(record.resumeKey);
+      if (record.resumeOffset != 0)
+      {
+        resumeOffsets[record.resumeKey] = record.resumeOffset;
+        resuming = true;
+      }
+    }
+    if (governor)
+    {
+      switch (governor->request(application.sessionId(), file->size(), record.admissionTicket, admitted))
+      {
+        case CUploadGovernor::A_ADMITTED:
+        {
+          admittedKeys.push_back(record.fileKey);
+          break;
+        }
+        case CUploadGovernor::A_QUEUED:
+        {
+          // Without the filter pipeline the browser cannot hold the file, so it is refused rather than failing mid-stream.
+
+          if (fileData.chunkSize != 0)
+          {
+            record.pendingText = "Waiting for space";
+          }
+          else
+          {
+            releaseAdmission(record);
+            record.pendingText = "Refused: server busy";
+            cancelUpload(file);
+          }
+          break;
+        }
+        case CUploadGovernor::A_REFUSED:
+        {
+          record.pendingText = "Refused: file too large";
+          cancelUpload(file);
+          break;
+        }
+        default:
+        {
+          CODE_ERROR();
+          // Does not return.
+        }
+      }
+    }
+    fileUploadSignal.emit(ID, file);
+  }
+  droppedModified.clear();
+
+  // The filter is sent with the response to the drop, so it is in place before the browser starts sending the files.
+
+  if (resuming)
+  {
+    updateFilter();
+  }
+  if (governor)
+  {
+    admitFiles(admittedKeys);
+  }
+
+  // If the maximum number of files has been met or exceeded, don't allow any more drops.
+  if (uploads().size() >= maxFiles_)
+  {
+    setAcceptDrops(false);
+  }
+
+}
+
+std::string CFileUploadWidget::gateRef() const
+{
+  return fmt::format("(function(gates) {{"
+                       "return gates[{0}] || (gates[{0}] = {{open: true, admission: false, admitted: {{}}, waiting: []}});"
+                     "}})"
+                     "(window.wtxGates || (window.wtxGates = {{}}))", Wt::WString(id()).jsStringLiteral());
+}
+
+CMappedUpload CFileUploadWidget::mapUpload(ID_t fileID, CMappedUpload::advice_e advice) const
+{
+  std::filesystem::path filePath;
+
+  shared_lock sl{fileData.mData};
+  if (fileData.byID.contains(fileID))
+  {
+    const_reference record = fileData.byID.at(fileID).get();
+    sl.unlock();
+
+    RUNTIME_ASSERT(record.status == S_COMPLETE, "CFileUploadWidget::mapUpload: Upload has not completed.");
+    filePath = uploadPath(record);
+  }
+  else
+  {
+    CODE_ERROR();
+    // Does not return.
+  }
+  return CMappedUpload(filePath, advice);
+}
+
+void CFileUploadWidget::moveUpload(ID_t fileID, std::filesystem::path const &destination, bool tmpFile)
+{
+  /* This function is called from the GUI thread. */
+
+  shared_lock sl{fileData.mData};
+  if (fileData.byID.contains(fileID))
+  {
+    reference record = fileData.byID.at(fileID).get();
+    sl.unlock();
+
+    RUNTIME_ASSERT(record.status == S_COMPLETE, "CFileUploadWidget::moveUpload: Upload has not completed.");
+    RUNTIME_ASSERT(record.processStatus != P_QUEUED && record.processStatus != P_PROCESSING,
+                   "CFileUploadWidget::moveUpload: File is being processed.");
+
+    moveFile(uploadPath(record), destination, tmpFile);
+
+    // The spool file is taken from Wt, so Wt does not remove a file that is later created with the same name.
+
+    if (record.movedFile.empty() && record.linkedFile.empty())
+    {
+      record.file->uploadedFile().stealSpoolFile();
+    }
+    record.movedFile = destination;
+    record.linkedFile.clear();
+    releaseAdmission(record);
+  }
+  else
+  {
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+void CFileUploadWidget::pauseUploads(bool pause)
+{
+  /* This function is called from the GUI thread. The gate holds the first chunk of the next file in the filter pipeline. The file
+   * being sent when the uploads are paused completes.
+   */
+
+  uploadsPaused = pause;
+  if (pause)
+  {
+    setAcceptDrops(false);
+    if (fileData.chunkSize != 0)
+    {
+      doJavaScript(fmt::format("{}.open = false;", gateRef()));
+    }
+  }
+  else
+  {
+    setAcceptDrops(uploads().size() < maxFiles_);
+    if (fileData.chunkSize != 0)
+    {
+      doJavaScript(fmt::format(
+        "(function(gate) {{"
+          "gate.open = true;"
+          "gate.waiting.splice(0).forEach(function(check) {{ check(); }});"
+        "}})({});", gateRef()));
+    }
+  }
+}
+
+void CFileUploadWidget::processFile(ID_t fileID, std::filesystem::path const &filePath,
+                                    std::filesystem::path const &clientFileName)
+{
+  /* This function is called from the GUI thread. The status changes are published in the same way as the detected types. */
+
+  if (processFunction)
+  {
+    bool pushMode = !pullMode;
+
+    {
+      std::lock_guard lg{processingStatus->mStatus};
+      processingStatus->queued++;
+    }
+
+    {
+      shared_lock sl{fileData.mData};
+      if (fileData.byID.contains(fileID))
+      {
+        fileData.byID.at(fileID).get().processStatus = P_QUEUED;
+      }
+    }
+    model->setCompletedText(fileID, "Queued");
+
+    processPool->submit([processFunction = processFunction, processingStatus = processingStatus, mailbox = mailbox,
+                         publish = applyClosure, pushMode, fileID, filePath, clientFileName]()
+    {
+      auto change = [&](processStatus_e processStatus, std::string text)
+      {
+        bool wasEmpty;
+
+        {
+          std::lock_guard lg{processingStatus->mStatus};
+          wasEmpty = processingStatus->changes.empty();
+          processingStatus->changes.emplace_back(fileID, processStatus, std::move(text));
+          if (processStatus != P_PROCESSING)
+          {
+            processingStatus->queued--;
+          }
+        }
+
+        if (wasEmpty && pushMode)
+        {
+          mailbox->post(publish);
+        }
+      };
+
+      bool cancelled;
+
+      {
+        std::lock_guard lg{processingStatus->mStatus};
+        cancelled = processingStatus->cancelled;
+      }
+
+      if (cancelled)
+      {
+        change(P_CANCELLED, "Cancelled");
+      }
+      else
+      {
+        change(P_PROCESSING, "Processing");
+
+        processStatus_e processStatus = P_PROCESSED;
+        std::string text;
+        try
+        {
+          text = processFunction(fileID, filePath, clientFileName);
+        }
+        catch(std::exception const &e)
+        {
+          processStatus = P_FAILED;
+          text = fmt::format("Processing failed: {}", e.what());
+        }
+        catch(...)
+        {
+          processStatus = P_FAILED;
+          text = "Processing failed";
+        }
+        change(processStatus, std::move(text));
+      }
+    });
+
+    // The file that completed may fill the queue.
+
+    updatePause();
+  }
+}
+
+void CFileUploadWidget::processing(process_f pf, std::size_t workers, std::size_t queueLimit)
+{
+  RUNTIME_ASSERT(workers != 0, "CFileUploadWidget::processing: Number of workers must be non-zero.");
+  RUNTIME_ASSERT(queueLimit != 0, "CFileUploadWidget::processing: Queue limit must be non-zero.");
+
+  processFunction = std::move(pf);
+  processQueueLimit = queueLimit;
+  if (processFunction)
+  {
+    processPool = std::make_unique<CThreadPool>(workers);
+  }
+  else
+  {
+    processPool.reset();
+  }
+
+  // The queue may no longer be full, and nothing else will resume the uploads.
+
+  updatePause();
+}
+
+void CFileUploadWidget::releaseAdmission(reference record)
+{
+  if (governor && record.admissionTicket != 0)
+  {
+    governor->release(record.admissionTicket);
+    record.admissionTicket = 0;
+  }
+}
+
+void CFileUploadWidget::resumeStore(std::shared_ptr<CUploadResumeStore> rs)
+{
+  unique_lock ul{fileData.mData};
+  fileData.resumeStore = std::move(rs);
+}
+
+void CFileUploadWidget::render(Wt::WFlags<Wt::RenderFlag> flags)
+{
+  if (!tableView)
+  {
+    createUI();
+  }
+  Wt::WFileDropWidget::render(flags);
+}
+
+void CFileUploadWidget::spoolDirectory(std::filesystem::path const &directory)
+{
+  unique_lock ul{fileData.mData};
+  fileData.spoolDirectory = directory;
+}
+
+void CFileUploadWidget::setCompletedText(ID_t fileID, std::string const &ct)
+{
+  bool wasEmpty;
+
+  {
+    std::lock_guard lg{mPending};
+    wasEmpty = pendingCompletedText.empty();
+    pendingCompletedText.emplace_back(fileID, ct);
+  }
+
+  if (wasEmpty && !pullMode)
+  {
+    mailbox->post(applyClosure);
+  }
+}
+
+std::filesystem::path CFileUploadWidget::uploadPath(const_reference record) const
+{
+  std::filesystem::path rv;
+
+  if (!record.movedFile.empty())
+  {
+    rv = record.movedFile;
+  }
+  else if (!record.linkedFile.empty())
+  {
+    rv = record.linkedFile;
+  }
+  else
+  {
+    rv = record.file->uploadedFile().spoolFileName();
+  }
+  return rv;
+}
+
+void CFileUploadWidget::updateFilter()
+{
+  if (fileData.chunkSize == 0)
+  {
+    setJavaScriptFilter("");
+  }
+  else
+  {
+    /* Each chunk is passed through the stages in turn. The pipeline tracks the position in each file, so chunks that the resume
+     * store already holds are replaced by empty chunks. While the gate is closed (pauseUploads()), or the file has not been
+     * admitted (admitFiles()), the first chunk of a file waits in the gate.
+     */
+
+    std::string resume;
+    for (auto const &[key, offset]: resumeOffsets)
+    {
+      resume += fmt::format("{}{}:{}", resume.empty() ? "" : ",", Wt::WString(key).jsStringLiteral(), offset);
+    }
+
+    std::string stages;
+    for (auto const &stage: filterStages)
+    {
+      stages += fmt::format("{}{}", stages.empty() ? "" : ",", stage);
+    }
+    if (fileData.compression)
+    {
+      // Each chunk is compressed as a separate gzip member. Files that are already compressed are sent as they are.
+
+      stages += fmt::format("{}{}", stages.empty() ? "" : ",",
+        "function(context, data) {"
+          "if (data.byteLength == 0 || typeof CompressionStream === 'undefined' ||"
+              "/^(image|video|audio)\\/|zip|compressed/.test(context.file.type)) {"
+            "return data;"
+          "}"
+          "return new Response(new Blob([data]).stream().pipeThrough(new CompressionStream('gzip'))).arrayBuffer()"
+            ".then(function(buffer) { return new Uint8Array(buffer); });"
+        "}");
+    }
+
+    setJavaScriptFilter(fmt::format(
+      "(function() {{"
+        "var resume = {{{0}}};"
+        "var stages = [{1}];"
+        "var position = {{}};"
+        "var gate = {2};"
+        "return function(file, chunk) {{"
+          "var key = file.name + ':' + file.size + ':' + (file.lastModified || 0);"
+          "var offset = position[key] || 0;"
+          "position[key] = offset + chunk.byteLength;"
+          "if (offset + chunk.byteLength >= file.size) {{ delete position[key]; }}"
+          "var data = offset < (resume[key] || 0) ? new Uint8Array(0) : new Uint8Array(chunk);"
+          "var context = {{file: file, offset: offset, last: offset + chunk.byteLength >= file.size}};"
+          "var ready = offset != 0 ? Promise.resolve() : new Promise(function(resolve) {{"
+            "var check = function() {{"
+              "if (gate.open && (!gate.admission || gate.admitted[key] > 0)) {{"
+                "if (gate.admission) {{ gate.admitted[key]--; }}"
+                "resolve();"
+              "}} else {{"
+                "gate.waiting.push(check);"
+              "}}"
+            "}};"
+            "check();"
+          "}});"
+          "return ready.then(function() {{"
+            "return stages.reduce(function(p, stage) {{ return p.then(function(d) {{ return stage(context, d); }}); }},"
+                                 "Promise.resolve(data));"
+          "}});"
+        "}};"
+      "}})()", resume, stages, gateRef()), fileData.chunkSize);
+  }
+}
+
+void CFileUploadWidget::updatePause()
+{
+  /* This function is called from the GUI thread whenever the queue or the limit may have changed, so the uploads are resumed even
+   * if there are no other changes to apply.
+   */
+
+  std::size_t queued;
+
+  {
+    std::lock_guard lg{processingStatus->mStatus};
+    queued = processingStatus->queued;
+  }
+
+  bool pause = processFunction && queued >= processQueueLimit;
+  if (pause != uploadsPaused)
+  {
+    pauseUploads(pause);
+  }
+}
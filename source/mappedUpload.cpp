@@ -0,0 +1,110 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                mappedUpload.cpp
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Read-only memory mapped view of a completed upload.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/mappedUpload.h"
+
+// Standard C++ library header files
+#include <cerrno>
+#include <system_error>
+
+// Linux header files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CMappedUpload::CMappedUpload(std::filesystem::path const &file, advice_e advice)
+{
+  int fileDescriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat status;
+
+  if (fileDescriptor < 0)
+  {
+    throw std::filesystem::filesystem_error("CMappedUpload: open", file, std::error_code(errno, std::generic_category()));
+  }
+  else if (fstat(fileDescriptor, &status) != 0)
+  {
+    int error = errno;
+    close(fileDescriptor);
+    throw std::filesystem::filesystem_error("CMappedUpload: fstat", file, std::error_code(error, std::generic_category()));
+  }
+  else if (status.st_size != 0)
+  {
+    // The mapping holds its own reference to the file, so the descriptor is closed once the file has been mapped.
+
+    void *mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    int error = errno;
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED)
+    {
+      throw std::filesystem::filesystem_error("CMappedUpload: mmap", file, std::error_code(error, std::generic_category()));
+    }
+
+    address = static_cast<char const *>(mapping);
+    size_ = static_cast<std::size_t>(status.st_size);
+
+    // The advice is only a hint. A failure does not affect the mapping.
+
+    switch (advice)
+    {
+      case A_SEQUENTIAL:
+      {
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        break;
+      }
+      case A_WILLNEED:
+      {
+        madvise(mapping, size_, MADV_WILLNEED);
+        break;
+      }
+      case A_RANDOM:
+      {
+        madvise(mapping, size_, MADV_RANDOM);
+        break;
+      }
+      default:
+      {
+        break;
+      }
+    }
+  }
+  else
+  {
+    close(fileDescriptor);
+  }
+}
+
+CMappedUpload::~CMappedUpload()
+{
+  if (address != nullptr)
+  {
+    munmap(const_cast<char *>(address), size_);
+  }
+}
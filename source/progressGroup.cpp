@@ -29,8 +29,14 @@
 //*********************************************************************************************************************************
 
 #include "include/progressGroup.h"
+#include "include/progressJournal.h"
+#include "include/progressSegment.h"
 
 // Standard C++ library header files
+#include <algorithm>
+#include <ctime>
+#include <map>
+#include <random>
 #include <vector>
 
 // Wt++ header files
@@ -46,6 +52,7 @@
 
 // Miscellaneous libraries
 #include <boost/locale.hpp>
+#include <fmt/format.h>
 #include <GCL>
 
 /* Multi-threading
@@ -69,6 +76,283 @@
  * atomics may be implemented using locks.
  */
 
+/// @brief      Returns the CPU time consumed by the calling thread.
+/// @returns    The CPU time of the calling thread.
+/// @throws     noexcept
+
+static std::chrono::nanoseconds threadCPUTime() noexcept
+{
+  timespec ts;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+  {
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+  else
+  {
+    return std::chrono::nanoseconds(0);
+  }
+}
+
+/// @brief      Calculates the timing information for an action item.
+/// @param[in]  actionItem: The item to calculate the timing for. The caller must hold a lock on actionItem.mActionItem.
+/// @returns    The timing information.
+/// @throws     noexcept
+
+static CProgressGroup::stepTiming_t calculateTiming(CProgressGroup::actionItem_t const &actionItem) noexcept
+{
+  CProgressGroup::stepTiming_t rv{actionItem.status.load(), actionItem.timeBegin, actionItem.timeComplete,
+                                  CProgressGroup::clock_type::duration::zero(), actionItem.cpuTime, actionItem.itemsDone, 0};
+
+  switch (rv.status)
+  {
+    case CProgressGroup::S_ACTIVE:
+    {
+      rv.elapsed = CProgressGroup::clock_type::now() - actionItem.timeBegin;
+      break;
+    }
+    case CProgressGroup::S_COMPLETE:
+    case CProgressGroup::S_CANCELLED:
+    {
+      rv.elapsed = actionItem.timeComplete - actionItem.timeBegin;
+      break;
+    }
+    default:
+    {
+      break;
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(rv.elapsed).count();
+  if (seconds > 0)
+  {
+    rv.itemsPerSecond = static_cast<double>(rv.itemsDone) / seconds;
+  }
+
+  return rv;
+}
+
+/// @brief      Calculates the timing information for an action, rolled up over all its descendants. An action that has not been
+///             begun itself spans its descendants. It begins with the first descendant to begin and completes with the last to
+///             complete. The CPU time and the items done are summed over the action and its descendants.
+/// @param[in]  data: The progress group data. (Must not be locked by the caller.)
+/// @param[in]  actionID: The action to calculate the timing for.
+/// @returns    The timing information.
+/// @throws     std::out_of_range if the action does not exist.
+
+static CProgressGroup::stepTiming_t calculateTreeTiming(CProgressGroup::data_t const &data, CProgressGroup::ID_t actionID)
+{
+  using actionItem_t = CProgressGroup::actionItem_t;
+
+  CProgressGroup::shared_lock sl{data.mData};
+  actionItem_t const &root = data.byID.at(actionID).get();
+  CProgressGroup::stepTiming_t rv;
+
+  {
+    CProgressGroup::shared_lock slAI{root.mActionItem};
+    rv = calculateTiming(root);
+  }
+
+  std::multimap<CProgressGroup::ID_t, actionItem_t const *> byParent;
+  for (auto const &item: data.actions)
+  {
+    byParent.emplace(item.PID, &item);
+  }
+
+  std::vector<CProgressGroup::ID_t> pending{actionID};
+  std::optional<CProgressGroup::clock_type::time_point> firstBegin;
+  CProgressGroup::clock_type::time_point lastComplete;
+  bool descendants = false;
+  bool allFinished = true;
+  bool anyCancelled = false;
+
+  while (!pending.empty())
+  {
+    auto [begin, end] = byParent.equal_range(pending.back());
+    pending.pop_back();
+
+    for (auto iter = begin; iter != end; ++iter)
+    {
+      actionItem_t const &item = *iter->second;
+      CProgressGroup::shared_lock slAI{item.mActionItem};
+      CProgressGroup::stepTiming_t timing = calculateTiming(item);
+
+      descendants = true;
+      pending.push_back(item.ID);
+      rv.cpuTime += timing.cpuTime;
+      rv.itemsDone += timing.itemsDone;
+      switch (timing.status)
+      {
+        case CProgressGroup::S_ACTIVE:
+        {
+          firstBegin = std::min(firstBegin.value_or(timing.timeBegin), timing.timeBegin);
+          allFinished = false;
+          break;
+        }
+        case CProgressGroup::S_COMPLETE:
+        case CProgressGroup::S_CANCELLED:
+        {
+          firstBegin = std::min(firstBegin.value_or(timing.timeBegin), timing.timeBegin);
+          lastComplete = std::max(lastComplete, timing.timeComplete);
+          anyCancelled = anyCancelled || (timing.status == CProgressGroup::S_CANCELLED);
+          break;
+        }
+        default:
+        {
+          allFinished = false;
+          break;
+        }
+      }
+    }
+  }
+
+  if (descendants)
+  {
+    if ((rv.status == CProgressGroup::S_NONE || rv.status == CProgressGroup::S_PENDING) && firstBegin)
+    {
+      rv.timeBegin = *firstBegin;
+      if (allFinished)
+      {
+        rv.status = anyCancelled ? CProgressGroup::S_CANCELLED : CProgressGroup::S_COMPLETE;
+        rv.timeComplete = lastComplete;
+        rv.elapsed = lastComplete - *firstBegin;
+      }
+      else
+      {
+        rv.status = CProgressGroup::S_ACTIVE;
+        rv.elapsed = CProgressGroup::clock_type::now() - *firstBegin;
+      }
+    }
+
+    double seconds = std::chrono::duration<double>(rv.elapsed).count();
+    rv.itemsPerSecond = (seconds > 0) ? static_cast<double>(rv.itemsDone) / seconds : 0;
+  }
+
+  return rv;
+}
+
+/// @brief      Converts an ETA in seconds to a duration.
+/// @param[in]  seconds: The ETA in seconds. (< 0 if not known)
+/// @returns    The ETA as a duration, or no value if not known.
+/// @throws     noexcept
+
+static std::optional<CProgressGroup::clock_type::duration> etaDuration(double seconds) noexcept
+{
+  if (seconds < 0)
+  {
+    return std::nullopt;
+  }
+  else
+  {
+    return std::chrono::duration_cast<CProgressGroup::clock_type::duration>(std::chrono::duration<double>(seconds));
+  }
+}
+
+/// @brief      Escapes a string for inclusion in a JSON document.
+/// @param[in]  str: The string to escape.
+/// @returns    The escaped string. (Not including the surrounding quotes.)
+/// @throws
+
+static std::string jsonEscape(std::string const &str)
+{
+  std::string rv;
+  rv.reserve(str.size());
+
+  for (char c: str)
+  {
+    switch (c)
+    {
+      case '"':
+      {
+        rv += "\\\"";
+        break;
+      }
+      case '\\':
+      {
+        rv += "\\\\";
+        break;
+      }
+      case '\n':
+      {
+        rv += "\\n";
+        break;
+      }
+      case '\r':
+      {
+        rv += "\\r";
+        break;
+      }
+      case '\t':
+      {
+        rv += "\\t";
+        break;
+      }
+      default:
+      {
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          rv += fmt::format("\\u{:04x}", static_cast<unsigned int>(c));
+        }
+        else
+        {
+          rv += c;
+        }
+        break;
+      }
+    }
+  }
+  return rv;
+}
+
+/// @brief      Returns the name of a status, as used in the JSON export.
+/// @param[in]  status: The status.
+/// @returns    The name of the status.
+/// @throws     noexcept
+
+static char const *statusName(CProgressGroup::status_e status) noexcept
+{
+  switch (status)
+  {
+    case CProgressGroup::S_PENDING:
+    {
+      return "pending";
+    }
+    case CProgressGroup::S_ACTIVE:
+    {
+      return "active";
+    }
+    case CProgressGroup::S_COMPLETE:
+    {
+      return "complete";
+    }
+    case CProgressGroup::S_CANCELLED:
+    {
+      return "cancelled";
+    }
+    default:
+    {
+      return "none";
+    }
+  }
+}
+
+/// @brief      Returns the current progress of an action. The progress of a step in counter mode is derived from the counter, so
+///             the value is current between the passes of the update thread.
+/// @param[in]  actionItem: The action. (Locked by the caller.)
+/// @returns    The progress. (0-1)
+/// @throws     noexcept
+
+static double currentProgress(CProgressGroup::actionItem_t const &actionItem) noexcept
+{
+  double rv = actionItem.progress.load();
+  std::uint64_t total = actionItem.unitsTotal.load();
+
+  if (total != 0 && actionItem.status == CProgressGroup::S_ACTIVE)
+  {
+    rv = std::min(1.0, static_cast<double>(actionItem.unitsDone.load(std::memory_order_relaxed)) / static_cast<double>(total));
+  }
+  return rv;
+}
 
 /* The CProgressGroupModel handles providing the parent/child hierarchy to the treeView. The model takes the list provided and
  * prepares the preOrder vector.
@@ -103,6 +387,36 @@ public:
    */
   virtual ~CProgressGroupModel() = default;
 
+  /*! @brief      Notifies the views that the data of all the actions may have changed. Called from the GUI thread.
+   *  @throws
+   */
+  void refresh()
+  {
+    std::map<ID_t, int> childCount;
+
+    // Actions inserted since the last refresh change the rows of the tree, so the views must re-read the layout.
+
+    if (data_.recordsUpdated.test())
+    {
+      data_.recordsUpdated.clear();
+      layoutAboutToBeChanged().emit();
+      layoutChanged().emit();
+    }
+
+    {
+      shared_lock sl{data_.mData};
+      for (auto const &item: data_.actions)
+      {
+        childCount[item.PID]++;
+      }
+    }
+
+    for (auto const &[PID, count]: childCount)
+    {
+      dataChanged().emit(createIndex(0, 0, PID), createIndex(count - 1, columnCount(Wt::WModelIndex()) - 1, PID));
+    }
+  }
+
 protected:
   virtual std::any headerData(int section, Wt::Orientation orientation, Wt::ItemDataRole role) const override
   {
@@ -126,6 +440,21 @@ protected:
               returnValue = static_cast<std::string>(boost::locale::translate("Status"));
               break;
             };
+            case 2:
+            {
+              returnValue = static_cast<std::string>(boost::locale::translate("Elapsed"));
+              break;
+            };
+            case 3:
+            {
+              returnValue = static_cast<std::string>(boost::locale::translate("Rate"));
+              break;
+            };
+            case 4:
+            {
+              returnValue = static_cast<std::string>(boost::locale::translate("ETA"));
+              break;
+            };
             default:
             {
               CODE_ERROR();
@@ -160,36 +489,20 @@ protected:
      *    +---------------------+-----------+--------+------------+---------+-----------------+
      */
 
-    int rv;
+    int rv = 0;
 
-    std::uint64_t ID;
     if (!indx.isValid())
     {
-      ID = 0;
+      shared_lock sl{data_.mData};
+      rv = data_.children.size();
     }
-    else
+    else if (indx.column() == 0)
     {
-      if (indx.column() != 0)
-      {
-        return 0;
-      }
-      else
-      {
-        shared_lock sl{data_.mData};
-        CProgressGroup::actionItem_t &actionItem = data_.byID.at(indx.internalId());
-        sl.unlock();
-        shared_lock slAI1{actionItem.mActionItem};
-        ID = actionItem.children.at(indx.row()).get().ID;
-        slAI1.unlock();
-        sl.lock();
-        CProgressGroup::actionItem_t &actionItem2 = data_.byID.at(ID);
-        sl.unlock();
-        shared_lock slAI2{actionItem2.mActionItem};
-        rv = actionItem2.children.size();
-      }
+      CProgressGroup::actionItem_t &actionItem = childItem(indx.internalId(), indx.row());
+      shared_lock slAI{actionItem.mActionItem};
+      rv = actionItem.children.size();
     }
 
-
     return rv;
   }
 
@@ -211,15 +524,11 @@ protected:
      *    +---------------------+-----------+--------+--------------+---------+-----------------+
      */
 
-    int PID = 0;
+    ID_t PID = 0;
 
     if (parent.isValid())
     {
-      shared_lock sl{data_.mData};
-      CProgressGroup::actionItem_t &actionItem = data_.byID.at(parent.internalId()).get();
-      sl.unlock();
-      shared_lock slAI{actionItem.mActionItem};
-      PID = actionItem.children.at(parent.row()).get().ID;
+      PID = childItem(parent.internalId(), parent.row()).ID;
     }
 
     return createIndex(row, col, PID);
@@ -248,22 +557,35 @@ protected:
     }
     else
     {
+      // The internal ID of an index is the ID of the parent. The row of the parent is its position in the grandparent.
+
       shared_lock sl{data_.mData};
-      CProgressGroup::actionItem_t &actionItem = data_.byID.at(indx.internalId()).get();
-      sl.unlock();
+      CProgressGroup::actionItem_t &parentItem = data_.byID.at(indx.internalId()).get();
+      int row;
 
-      shared_lock slAI{actionItem.mActionItem};
-      return createIndex(actionItem.PID, 0, actionItem.ID);
+      if (parentItem.PID == 0)
+      {
+        row = childRow(data_.children, parentItem.ID);
+      }
+      else
+      {
+        CProgressGroup::actionItem_t &grandparentItem = data_.byID.at(parentItem.PID).get();
+        sl.unlock();
+        shared_lock slGP{grandparentItem.mActionItem};
+        row = childRow(grandparentItem.children, parentItem.ID);
+      }
+
+      return createIndex(row, 0, parentItem.PID);
     }
   }
 
-  /// @brief      Returns the number of columns. This is always 2.
+  /// @brief      Returns the number of columns. This is always 5.
   /// @param[in]  ignored
-  /// @returns    2.
+  /// @returns    5.
   /// @throws     noexcept
   /// @version    2024-04-29/GGB - Function created.
 
-  virtual int columnCount(const Wt::WModelIndex &) const noexcept override { return 2; }
+  virtual int columnCount(const Wt::WModelIndex &) const noexcept override { return 5; }
 
   /// @brief      Returns the data for the specified model index.
   /// @param[in]  index: The index to return the data for
@@ -280,12 +602,16 @@ protected:
      *    +---------------------+-----------+--------+--------------+---------+-----------------+
      */
 
-    shared_lock sl{data_.mData};
-    CProgressGroup::actionItem_t &actionItem = data_.byID.at(index.internalId()).get();
-    sl.unlock();
-    shared_lock slAI{actionItem.mActionItem};
-    CProgressGroup::actionItem_t &actionItem2 = actionItem.children.at(index.row()).get();
-    slAI.unlock();
+    CProgressGroup::actionItem_t &actionItem2 = childItem(index.internalId(), index.row());
+
+    // The elapsed time and the rate are rolled up over the descendants. This takes its own locks, so is done first.
+
+    CProgressGroup::stepTiming_t timing{};
+    if (index.column() == 2 || index.column() == 3)
+    {
+      timing = calculateTreeTiming(data_, actionItem2.ID);
+    }
+
     shared_lock slAI2{actionItem2.mActionItem};
 
     std::any rv;
@@ -320,11 +646,21 @@ protected:
                 //rv = parent.initialText;
                 break;
               }
+              case CProgressGroup::S_ACTIVE:
+              {
+                rv = fmt::format("{:.0f} %", currentProgress(actionItem2) * 100);
+                break;
+              }
               case CProgressGroup::S_COMPLETE:
               {
                 //rv = parent.finalText;
                 break;
               }
+              case CProgressGroup::S_CANCELLED:
+              {
+                rv = static_cast<std::string>(boost::locale::translate("Cancelled"));
+                break;
+              }
               default:
               {
                 CODE_ERROR();
@@ -333,6 +669,11 @@ protected:
             }
             break;
           }
+          case Wt::ItemDataRole::User:
+          {
+            rv = currentProgress(actionItem2);
+            break;
+          }
           default:
           {
             break;
@@ -340,6 +681,32 @@ protected:
         }
         break;
       };
+      case 2: // Elapsed time.
+      {
+        if (role.value() == Wt::ItemDataRole::Display && timing.status != CProgressGroup::S_NONE &&
+            timing.status != CProgressGroup::S_PENDING)
+        {
+          rv = fmt::format("{:.1f} s", std::chrono::duration<double>(timing.elapsed).count());
+        }
+        break;
+      }
+      case 3: // Throughput.
+      {
+        if (role.value() == Wt::ItemDataRole::Display && timing.itemsDone != 0)
+        {
+          rv = fmt::format("{:.1f} /s", timing.itemsPerSecond);
+        }
+        break;
+      }
+      case 4: // Estimated time remaining.
+      {
+        if (role.value() == Wt::ItemDataRole::Display && actionItem2.status == CProgressGroup::S_ACTIVE &&
+            actionItem2.etaSeconds >= 0)
+        {
+          rv = fmt::format("{:.0f} s", actionItem2.etaSeconds.load());
+        }
+        break;
+      }
       default:
       {
         CODE_ERROR();
@@ -358,6 +725,43 @@ private:
   CProgressGroupModel &operator=(CProgressGroupModel const &) = delete;
   CProgressGroupModel &operator=(CProgressGroupModel &&) = delete;
 
+  /// @brief      Returns the row of a child in the list of children.
+  /// @param[in]  children: The list of children. (Locked by the caller.)
+  /// @param[in]  ID: The ID of the child.
+  /// @returns    The row of the child.
+  /// @throws     std::runtime_error if the child is not in the list.
+
+  static int childRow(SCL::vector_sorted<value_ref> const &children, ID_t ID)
+  {
+    auto iter = std::find_if(children.begin(), children.end(), [ID](value_ref const &child) { return child.get().ID == ID; });
+    RUNTIME_ASSERT(iter != children.end(), "CProgressGroupModel::childRow: Child not found.");
+
+    return static_cast<int>(std::distance(children.begin(), iter));
+  }
+
+  /// @brief      Returns the child of an action.
+  /// @param[in]  PID: The ID of the parent. (0 for the top level actions.)
+  /// @param[in]  row: The row of the child.
+  /// @returns    The child action.
+  /// @throws     std::out_of_range if the parent or the row does not exist.
+
+  CProgressGroup::actionItem_t &childItem(ID_t PID, int row) const
+  {
+    shared_lock sl{data_.mData};
+
+    if (PID == 0)
+    {
+      return data_.children.at(row).get();
+    }
+    else
+    {
+      CProgressGroup::actionItem_t &parentItem = data_.byID.at(PID).get();
+      sl.unlock();
+      shared_lock slPI{parentItem.mActionItem};
+      return parentItem.children.at(row).get();
+    }
+  }
+
   data_type &data_;                                          // Refers to the list maintained by the progress group.
 };
 
@@ -454,48 +858,239 @@ private:
   CProgressItemDelegate &operator=(CProgressItemDelegate &&) = delete;
 };
 
-CProgressGroup::CProgressGroup(Wt::WApplication &a, std::string const &pt, std::string const &ct) : application(a)
+CProgressGroup::CProgressGroup(Wt::WApplication &a, std::string const &pt, std::string const &ct) : application(a),
+  mailbox(CUpdateMailbox::instance(a))
 {
   data.pendingText = pt;
   data.completeText = ct;
-  model = std::make_shared<CProgressGroupModel>(data);
 
-  createWidget();
+  // The epoch distinguishes the snapshot versions of this group from those of any earlier group, or process.
+
+  std::random_device randomDevice;
+  snapshotEpoch = (static_cast<std::uint64_t>(randomDevice()) << 32) | randomDevice();
+
+  // The refresh closure is created here, as bindSafe() must be called from the GUI thread.
+
+  refreshModel = bindSafe([this]()
+  {
+    if (model)
+    {
+      model->refresh();
+    }
+  });
+  mailbox->requirePush(true);
+  updateThread_ = std::jthread([this](std::stop_token stopToken) { updateThread(stopToken); });
 }
 
-void CProgressGroup::beginStep(ID_t actionID)
+/// @brief    Stops and joins the update thread.
+
+CProgressGroup::~CProgressGroup()
 {
-  /*    +---------------------+-----------+--------+------------+---------+-----------------+
-   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
-   *    |---------------------|-----------+--------+------------+---------+-----------------+
-   *    | 1. Outside Threads  |  YES      | SHARED | UNIQUE     | UNIQUE  |                 |
-   *    | 2. Update Thread    |  NO       |        |            |         |                 |
-   *    | 3. GUI Thread       | POSSIBLE  | SHARED |            | UNIQUE  |                 |
-   *    +---------------------+-----------+--------+------------+---------+-----------------+
-   */
+  updateThread_.request_stop();
+  sUpdateRequired.release();
+  updateThread_.join();
+  mailbox->requirePush(false);
+}
 
-  unique_lock ul{data.mData};
+void CProgressGroup::attachJournal(std::shared_ptr<CProgressJournal> j, bool replay)
+{
+  if (replay)
+  {
+    // Reduce the journal to the final state of each step, then apply it.
+
+    std::map<ID_t, CProgressJournal::record_t> finalState;
+    j->replay([&finalState](CProgressJournal::record_t const &record)
+    {
+      CProgressJournal::record_t &state = finalState[record.ID];
+      if (state.type != CProgressJournal::JR_COMPLETE)
+      {
+        state = record;
+      }
+    });
+
+    for (auto const &[ID, record]: finalState)
+    {
+      {
+        shared_lock sl{data.mData};
+        if (!data.byID.contains(ID))
+        {
+          continue;
+        }
+      }
+
+      switch (record.type)
+      {
+        case CProgressJournal::JR_COMPLETE:
+        {
+          beginStep(ID);
+          completeStep(ID);
+          break;
+        }
+        case CProgressJournal::JR_PROGRESS:
+        {
+          updateStep(ID, record.value);
+          break;
+        }
+        default:
+        {
+          break;
+        }
+      }
+    }
+  }
+
+  journal = std::move(j);
+}
+
+void CProgressGroup::attachSegment(std::shared_ptr<CProgressSegment> segment)
+{
+  std::lock_guard lg{mSegments};
+
+  segments.push_back(std::move(segment));
+  attachedSegments = segments.size();
+  sUpdateRequired.release();
+}
+
+void CProgressGroup::beginStep(ID_t actionID, bool measureCPU)
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | UNIQUE     | UNIQUE  |                 |
+   *    | 2. Update Thread    |  NO       |        |            |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED |            | UNIQUE  |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  unique_lock ul{data.mData};
 
   if (data.byID.contains(actionID))
   {
     actionItem_t &actionItem = data.byID.at(actionID).get();
     ul.unlock();
     unique_lock ulAI{actionItem.mActionItem};
-    actionItem.status.store(S_ACTIVE);
+    if (actionItem.status != S_CANCELLED)
+    {
+      if (actionItem.unitsTotal != 0 && actionItem.status != S_ACTIVE)
+      {
+        activeCounters++;
+      }
+      actionItem.status.store(S_ACTIVE);
+      actionItem.timeBegin = clock_type::now();
+      actionItem.beginThread = measureCPU ? std::this_thread::get_id() : std::thread::id();
+      actionItem.cpuBegin = measureCPU ? threadCPUTime() : std::chrono::nanoseconds(0);
+      actionItem.lastCheckpoint = actionItem.timeBegin;
+      if (journal)
+      {
+        journal->append(CProgressJournal::JR_BEGIN, actionID);
+      }
+      changeCount++;
+    }
     ulAI.unlock();
-    unique_lock ulM{data.mModel};
-    //model->updateAction(actionID);
+    sUpdateRequired.release();
+  }
+  else
+  {
+    CODE_ERROR();
+    // Does not return.
+  }
+
+}
+
+void CProgressGroup::cancelStep(ID_t actionID)
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | UNIQUE     |         |  RELEASE        |
+   *    | 2. Update Thread    |  NO       |        |            |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED | UNIQUE     |         |  RELEASE        |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    actionItem_t &actionItem = data.byID.at(actionID).get();
+    sl.unlock();
+    unique_lock ulAI{actionItem.mActionItem};
+
+    actionItem.stopSource.request_stop();
+    if (actionItem.status == S_PENDING || actionItem.status == S_ACTIVE)
+    {
+      if (actionItem.unitsTotal != 0 && actionItem.status == S_ACTIVE)
+      {
+        activeCounters--;
+      }
+      actionItem.timeComplete = clock_type::now();
+      if (actionItem.status == S_PENDING)
+      {
+        actionItem.timeBegin = actionItem.timeComplete;
+      }
+      actionItem.status.store(S_CANCELLED);
+      changeCount++;
+      sUpdateRequired.release();
+    }
   }
   else
   {
+    sl.unlock();
     CODE_ERROR();
     // Does not return.
   }
+}
+
+void CProgressGroup::cancelSubtree(ID_t actionID)
+{
+  std::vector<ID_t> subtree;
+
+  {
+    shared_lock sl{data.mData};
+
+    if (actionID != 0)
+    {
+      if (!data.byID.contains(actionID))
+      {
+        sl.unlock();
+        CODE_ERROR();
+        // Does not return.
+      }
+      subtree.push_back(actionID);
+    }
+
+    std::map<ID_t, std::vector<ID_t>> children;
+    for (auto const &item: data.actions)
+    {
+      children[item.PID].push_back(item.ID);
+    }
+
+    std::vector<ID_t> stack{actionID};
+    while (!stack.empty())
+    {
+      ID_t ID = stack.back();
+      stack.pop_back();
+      if (children.contains(ID))
+      {
+        for (ID_t child: children.at(ID))
+        {
+          subtree.push_back(child);
+          stack.push_back(child);
+        }
+      }
+    }
+  }
 
+  for (ID_t ID: subtree)
+  {
+    cancelStep(ID);
+  }
 }
 
 void CProgressGroup::createWidget()
 {
+  model = std::make_shared<CProgressGroupModel>(data);
+
   setLayoutSizeAware(true);
   setOverflow(Wt::Overflow::Scroll);
   treeView = addWidget(std::make_unique<Wt::WTreeView>());
@@ -521,10 +1116,36 @@ void CProgressGroup::completeStep(ID_t actionID)
     actionItem_t &actionItem = data.byID.at(actionID).get();
     ul.unlock();
     unique_lock ulAI{actionItem.mActionItem};
-    actionItem.status.store(S_COMPLETE);
+    if (actionItem.status != S_CANCELLED && actionItem.status != S_COMPLETE)
+    {
+      if (actionItem.unitsTotal != 0)
+      {
+        std::uint64_t done = actionItem.unitsDone.load();
+        actionItem.itemsDone = done;
+        actionItem.progress.store(std::min(1.0, static_cast<double>(done) / static_cast<double>(actionItem.unitsTotal.load())));
+        if (actionItem.status == S_ACTIVE)
+        {
+          activeCounters--;
+        }
+      }
+      actionItem.status.store(S_COMPLETE);
+      actionItem.timeComplete = clock_type::now();
+      if (actionItem.beginThread == std::this_thread::get_id())
+      {
+        actionItem.cpuTime = threadCPUTime() - actionItem.cpuBegin;
+      }
+      if (traceEnabled)
+      {
+        actionItem.progressSamples.emplace_back(actionItem.timeComplete, actionItem.progress.load());
+      }
+      if (journal)
+      {
+        journal->append(CProgressJournal::JR_COMPLETE, actionID);
+      }
+      changeCount++;
+    }
     ulAI.unlock();
-    unique_lock ulM{data.mModel};
-    //model->updateAction(actionID);
+    sUpdateRequired.release();
   }
   else
   {
@@ -533,6 +1154,182 @@ void CProgressGroup::completeStep(ID_t actionID)
   }
 }
 
+void CProgressGroup::detachSegment(std::shared_ptr<CProgressSegment> const &segment)
+{
+  std::lock_guard lg{mSegments};
+
+  std::erase(segments, segment);
+  attachedSegments = segments.size();
+}
+
+void CProgressGroup::exportSnapshot(std::ostream &os, snapshot_t const &snapshot, std::uint64_t since)
+{
+  auto number = [](double value) -> std::string { return (value < 0) ? "null" : fmt::format("{:.4g}", value); };
+
+  os << fmt::format(R"({{"epoch":"{:x}","version":{},"since":{},"eta":{},"actions":[)", snapshot.epoch, snapshot.version, since,
+                    number(snapshot.overallETASeconds));
+
+  bool first = true;
+  for (auto const &item: snapshot.items)
+  {
+    if (item.version > since)
+    {
+      os << (first ? "" : ",")
+         << fmt::format(R"({{"id":{},"parent":{},"text":"{}","status":"{}","progress":{:.4g},"eta":{}}})", item.ID, item.PID,
+                        jsonEscape(item.text), statusName(item.status), item.progress, number(item.etaSeconds));
+      first = false;
+    }
+  }
+
+  os << "]}";
+}
+
+void CProgressGroup::exportTrace(std::ostream &os) const
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | SHARED     |         |                 |
+   *    | 2. Update Thread    |  NO       |        |            |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED | SHARED     |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  /* Trace viewers nest complete ("X") slices that are on the same track and contained in time. Each top level action is given
+   * its own track (tid) and its descendants are written on the same track. Siblings that overlap in time (run concurrently) would
+   * not nest, so they are spread over lanes. The first lane is the parent's track, and each further lane is a new track. A
+   * sibling is placed in the first lane that is free when it begins. Timestamps are in microseconds from the first step that
+   * was begun.
+   */
+
+  using microseconds = std::chrono::duration<double, std::micro>;
+
+  shared_lock sl{data.mData};
+
+  std::map<ID_t, std::vector<actionItem_t const *>> children;
+  for (auto const &item: data.actions)
+  {
+    children[item.PID].push_back(&item);
+  }
+  for (auto &child: children)
+  {
+    std::sort(child.second.begin(), child.second.end(),
+              [](actionItem_t const *lhs, actionItem_t const *rhs) { return lhs->sortOrder < rhs->sortOrder; });
+  }
+
+  clock_type::time_point now = clock_type::now();
+  clock_type::time_point epoch = now;
+  ID_t nextTrack = 1;
+  for (auto const &item: data.actions)
+  {
+    shared_lock slAI{item.mActionItem};
+    if (item.status != S_PENDING && item.status != S_NONE)
+    {
+      epoch = std::min(epoch, item.timeBegin);
+    }
+    nextTrack = std::max(nextTrack, item.ID + 1);
+  }
+
+  bool first = true;
+  auto separator = [&]() -> std::ostream & { os << (first ? "\n" : ",\n"); first = false; return os; };
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  std::function<void(ID_t, ID_t, std::string const &)> writeChildren = [&](ID_t PID, ID_t track, std::string const &trackName)
+  {
+    if (!children.contains(PID))
+    {
+      return;
+    }
+
+    // Assign the begun children to lanes, in order of beginning.
+
+    std::map<ID_t, ID_t> tids;
+    if (PID != 0)
+    {
+      struct span_t
+      {
+        clock_type::time_point begin;
+        clock_type::time_point end;
+        ID_t ID;
+      };
+      std::vector<span_t> spans;
+
+      for (actionItem_t const *item: children.at(PID))
+      {
+        shared_lock slAI{item->mActionItem};
+        if (item->status != S_PENDING && item->status != S_NONE)
+        {
+          spans.push_back({item->timeBegin, (item->status == S_ACTIVE) ? now : item->timeComplete, item->ID});
+        }
+      }
+      std::sort(spans.begin(), spans.end(), [](span_t const &lhs, span_t const &rhs) { return lhs.begin < rhs.begin; });
+
+      std::vector<std::pair<ID_t, clock_type::time_point>> lanes{{track, clock_type::time_point::min()}};
+      for (auto const &span: spans)
+      {
+        auto lane = std::find_if(lanes.begin(), lanes.end(), [&span](auto const &l) { return l.second <= span.begin; });
+        if (lane == lanes.end())
+        {
+          separator() << fmt::format(R"~({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{} ({})"}}}})~",
+                                     nextTrack, jsonEscape(trackName), lanes.size());
+          lanes.emplace_back(nextTrack++, span.end);
+          lane = std::prev(lanes.end());
+        }
+        lane->second = span.end;
+        tids[span.ID] = lane->first;
+      }
+    }
+
+    for (actionItem_t const *item: children.at(PID))
+    {
+      ID_t tid = (PID == 0) ? item->ID : (tids.contains(item->ID) ? tids.at(item->ID) : track);
+
+      if (PID == 0)
+      {
+        separator() << fmt::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+                                   tid, jsonEscape(item->itemText));
+      }
+
+      shared_lock slAI{item->mActionItem};
+      if (item->status != S_PENDING && item->status != S_NONE)
+      {
+        stepTiming_t timing = calculateTiming(*item);
+
+        separator() << fmt::format(R"({{"name":"{}","cat":"step","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f},)"
+                                   R"("args":{{"id":{},"cpu_ms":{:.3f},"items":{},"items_per_sec":{:.3f}}}}})",
+                                   jsonEscape(item->itemText), tid,
+                                   microseconds(item->timeBegin - epoch).count(), microseconds(timing.elapsed).count(),
+                                   item->ID, std::chrono::duration<double, std::milli>(timing.cpuTime).count(),
+                                   timing.itemsDone, timing.itemsPerSecond);
+
+        // The counter series is keyed by the action ID, so that steps with the same text are kept apart.
+
+        for (auto const &sample: item->progressSamples)
+        {
+          separator() << fmt::format(R"({{"name":"{} #{}","id":{},"cat":"progress","ph":"C","pid":1,"ts":{:.3f},)"
+                                     R"("args":{{"progress":{}}}}})",
+                                     jsonEscape(item->itemText), item->ID, item->ID, microseconds(sample.first - epoch).count(),
+                                     sample.second);
+        }
+      }
+      std::string childTrackName = (PID == 0) ? item->itemText : trackName;
+      slAI.unlock();
+
+      writeChildren(item->ID, tid, childTrackName);
+    }
+  };
+
+  writeChildren(0, 0, "");
+
+  os << "\n]}\n";
+}
+
+std::optional<CProgressGroup::clock_type::duration> CProgressGroup::overallETA() const noexcept
+{
+  return etaDuration(overallETASeconds.load());
+}
+
 void CProgressGroup::insertAction(ID_t actionID, ID_t parentID, ID_t sortOrder, std::string const &actionText)
 {
   /*    +---------------------+-----------+--------+------------+---------+-----------------+
@@ -547,15 +1344,495 @@ void CProgressGroup::insertAction(ID_t actionID, ID_t parentID, ID_t sortOrder,
   unique_lock ul{data.mData};
   actionItem_t &actionItem = data.actions.emplace_front(actionID, parentID, sortOrder, actionText);
   data.byID.emplace(actionID, std::ref(actionItem));
-  actionItem_t &parentItem = data.byID.at(actionItem.PID).get();
   data.parentChild.clear();  // Invalidate the tree.
-  ul.unlock();
 
-  unique_lock ulPI{parentItem.mActionItem};
-  //parentItem.children.emplace(std::ref(actionItem));
-  ulPI.unlock();
+  if (actionItem.PID != 0)    // PID 0 is the root and does not have an action item.
+  {
+    actionItem_t &parentItem = data.byID.at(actionItem.PID).get();
+    ul.unlock();
+
+    unique_lock ulPI{parentItem.mActionItem};
+    parentItem.children.emplace(std::ref(actionItem));
+    ulPI.unlock();
+  }
+  else
+  {
+    data.children.emplace(std::ref(actionItem));
+    ul.unlock();
+  }
 
   data.recordsUpdated.test_and_set();
+  changeCount++;
+}
+
+void CProgressGroup::measureCPU(ID_t actionID)
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | UNIQUE     |         |                 |
+   *    | 2. Update Thread    |  NO       |        |            |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED | UNIQUE     |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    actionItem_t &actionItem = data.byID.at(actionID).get();
+    sl.unlock();
+
+    unique_lock ulAI{actionItem.mActionItem};
+    if (actionItem.status == S_ACTIVE)
+    {
+      actionItem.beginThread = std::this_thread::get_id();
+      actionItem.cpuBegin = threadCPUTime();
+    }
+  }
+  else
+  {
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+CProgressGroup::stepTiming_t CProgressGroup::stepTiming(ID_t actionID) const
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | SHARED     |         |                 |
+   *    | 2. Update Thread    |  NO       |        |            |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED | SHARED     |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    sl.unlock();
+    return calculateTreeTiming(data, actionID);
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+std::shared_ptr<CProgressGroup::snapshot_t const> CProgressGroup::publishSnapshot() const
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |  YES      | SHARED | SHARED     |         |                 |
+   *    | 2. Update Thread    |  YES      | SHARED | SHARED     |         |                 |
+   *    | 3. GUI Thread       | POSSIBLE  | SHARED | SHARED     |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  std::lock_guard lg{mSnapshot};
+
+  // Counters do not change the change count, so the snapshot is always rebuilt while any are active.
+
+  std::shared_ptr<snapshot_t const> previous = publishedSnapshot.load();
+  std::uint64_t count = changeCount.load();
+  if (previous && previous->changeCount == count && activeCounters == 0)
+  {
+    return previous;
+  }
+
+  auto current = std::make_shared<snapshot_t>();
+  current->epoch = snapshotEpoch;
+  current->version = previous ? previous->version + 1 : 1;
+  current->changeCount = count;
+  current->taken = clock_type::now();
+  current->overallETASeconds = overallETASeconds.load();
+
+  {
+    shared_lock sl{data.mData};
+
+    for (auto const &item: data.actions)
+    {
+      shared_lock slAI{item.mActionItem};
+      current->items.push_back({item.ID, item.PID, item.itemText, item.status.load(), currentProgress(item), item.etaSeconds.load(),
+                                current->version});
+    }
+  }
+  std::sort(current->items.begin(), current->items.end(),
+            [](snapshotItem_t const &lhs, snapshotItem_t const &rhs) { return lhs.ID < rhs.ID; });
+
+  // Carry forward the version of the items that have not changed. If nothing has changed, the previous snapshot is retained.
+
+  std::vector<snapshotItem_t> const noItems;
+  std::vector<snapshotItem_t> const &previousItems = previous ? previous->items : noItems;
+  bool changed = !previous || current->overallETASeconds != previous->overallETASeconds;
+  auto prevIter = previousItems.begin();
+  for (auto &item: current->items)
+  {
+    while (prevIter != previousItems.end() && prevIter->ID < item.ID)
+    {
+      prevIter++;
+    }
+    if (prevIter != previousItems.end() && prevIter->ID == item.ID && prevIter->status == item.status &&
+        prevIter->progress == item.progress && prevIter->etaSeconds == item.etaSeconds)
+    {
+      item.version = prevIter->version;
+    }
+    else
+    {
+      changed = true;
+    }
+  }
+
+  if (!changed)
+  {
+    // Record the change count so that the unchanged group is not rescanned.
+
+    auto retained = std::make_shared<snapshot_t>(*previous);
+    retained->changeCount = count;
+    retained->taken = current->taken;
+    publishedSnapshot.store(retained);
+    return retained;
+  }
+
+  publishedSnapshot.store(current);
+  return current;
+}
+
+void CProgressGroup::render(Wt::WFlags<Wt::RenderFlag> flags)
+{
+  if (treeView == nullptr)
+  {
+    createWidget();
+  }
+  Wt::WContainerWidget::render(flags);
+}
+
+void CProgressGroup::setStepUnits(ID_t actionID, std::uint64_t total)
+{
+  RUNTIME_ASSERT(total != 0, "CProgressGroup::setStepUnits: Total units must be non-zero.");
+
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    actionItem_t &actionItem = data.byID.at(actionID).get();
+    sl.unlock();
+    unique_lock ulAI{actionItem.mActionItem};
+    if (actionItem.unitsTotal == 0 && actionItem.status == S_ACTIVE)
+    {
+      activeCounters++;
+    }
+    actionItem.unitsDone.store(0);
+    actionItem.unitsTotal.store(total);
+    actionItem.progress.store(0);
+    changeCount++;
+    sUpdateRequired.release();
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+std::atomic<std::uint64_t> &CProgressGroup::stepCounter(ID_t actionID)
+{
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    return data.byID.at(actionID).get().unitsDone;
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+CProgressGroup::ID_t CProgressGroup::parentID(ID_t actionID) const
+{
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    return data.byID.at(actionID).get().PID;
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+void CProgressGroup::pollSegments()
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |   NO      |        |            |         |                 |
+   *    | 2. Update Thread    |  YES      | SHARED | UNIQUE     | UNIQUE  |  RELEASE        |
+   *    | 3. GUI Thread       |   NO      |        |            |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  std::lock_guard lg{mSegments};
+
+  for (auto &segment: segments)
+  {
+    segment->poll([this](CProgressSegment::sample_t const &sample)
+    {
+      {
+        // Slots written by other processes are not trusted to refer to existing actions.
+
+        shared_lock sl{data.mData};
+        if (!data.byID.contains(sample.ID))
+        {
+          return;
+        }
+      }
+
+      if (sample.begun)
+      {
+        beginStep(sample.ID);
+      }
+      if (sample.denom != 0)
+      {
+        updateStep(sample.ID, sample.num, sample.denom);
+      }
+      if (sample.completed)
+      {
+        completeStep(sample.ID);
+      }
+    });
+  }
+}
+
+std::stop_token CProgressGroup::stopToken(ID_t actionID) const
+{
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    actionItem_t const &actionItem = data.byID.at(actionID).get();
+    sl.unlock();
+    shared_lock slAI{actionItem.mActionItem};
+    return actionItem.stopSource.get_token();
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+CProgressGroup::status_e CProgressGroup::stepStatus(ID_t actionID) const
+{
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    return data.byID.at(actionID).get().status.load();
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+std::shared_ptr<CProgressGroup::snapshot_t const> CProgressGroup::snapshot() const
+{
+  std::shared_ptr<snapshot_t const> current = publishedSnapshot.load();
+
+  // Counters do not change the change count. While any are active, a snapshot that is older than the interval is republished,
+  // so that polls do not lock all the actions every time.
+
+  if (current && current->changeCount == changeCount.load() &&
+      (activeCounters == 0 || clock_type::now() - current->taken < snapshotInterval))
+  {
+    return current;
+  }
+  else
+  {
+    return publishSnapshot();
+  }
+}
+
+std::optional<CProgressGroup::clock_type::duration> CProgressGroup::stepETA(ID_t actionID) const
+{
+  shared_lock sl{data.mData};
+
+  if (data.byID.contains(actionID))
+  {
+    return etaDuration(data.byID.at(actionID).get().etaSeconds.load());
+  }
+  else
+  {
+    sl.unlock();
+    CODE_ERROR();
+    // Does not return.
+  }
+}
+
+void CProgressGroup::updateEstimates()
+{
+  /*    +---------------------+-----------+--------+------------+---------+-----------------+
+   *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
+   *    |---------------------|-----------+--------+------------+---------+-----------------+
+   *    | 1. Outside Threads  |   NO      |        |            |         |                 |
+   *    | 2. Update Thread    |  YES      | SHARED | UNIQUE     |         |                 |
+   *    | 3. GUI Thread       |   NO      |        |            |         |                 |
+   *    +---------------------+-----------+--------+------------+---------+-----------------+
+   */
+
+  /* Each active leaf step samples its progress once per update pass. The rate over the pass is smoothed with an EWMA. A parent's
+   * progress is the mean of its children's progress, so the parent's rate is the mean of its children's rates. The tree is
+   * processed deepest first so that the children are always estimated before the parents.
+   * The ETA is then (1 - progress) / rate. The change count is only incremented if a progress or an ETA changed, so that the
+   * snapshot is not re-published when nothing changed.
+   */
+
+  struct estimate_t
+  {
+    double progress;
+    double rate;
+  };
+
+  clock_type::time_point now = clock_type::now();
+  shared_lock sl{data.mData};
+
+  std::vector<std::pair<std::size_t, actionItem_t *>> ordered;
+  std::map<ID_t, std::vector<ID_t>> children;
+  for (auto &item: data.actions)
+  {
+    std::size_t depth = 0;
+    for (ID_t PID = item.PID; PID != 0; PID = data.byID.at(PID).get().PID)
+    {
+      depth++;
+    }
+    ordered.emplace_back(depth, &item);
+    children[item.PID].push_back(item.ID);
+  }
+  std::stable_sort(ordered.begin(), ordered.end(), [](auto const &lhs, auto const &rhs) { return lhs.first > rhs.first; });
+
+  bool changed = false;
+  std::map<ID_t, estimate_t> estimates;
+  for (auto &[depth, item]: ordered)
+  {
+    unique_lock ulAI{item->mActionItem};
+
+    if (item->unitsTotal != 0 && item->status == S_ACTIVE)
+    {
+      // Store the progress derived from the counter, so that it rolls up to the parents.
+
+      item->itemsDone = item->unitsDone.load(std::memory_order_relaxed);
+      double progress = currentProgress(*item);
+      changed |= item->progress.exchange(progress) != progress;
+    }
+
+    estimate_t estimate{item->progress.load(), 0};
+
+    if (children.contains(item->ID))
+    {
+      estimate.progress = 0;
+      for (ID_t child: children.at(item->ID))
+      {
+        estimate.progress += estimates.at(child).progress;
+        estimate.rate += estimates.at(child).rate;
+      }
+      estimate.progress /= children.at(item->ID).size();
+      estimate.rate /= children.at(item->ID).size();
+      item->rate = estimate.rate;
+      changed |= item->progress.exchange(estimate.progress) != estimate.progress;
+    }
+    else
+    {
+      switch (item->status)
+      {
+        case S_ACTIVE:
+        {
+          bool firstSample = item->lastSampleTime < item->timeBegin;
+          clock_type::time_point sampleFrom = firstSample ? item->timeBegin : item->lastSampleTime;
+          double progressFrom = firstSample ? 0 : item->lastSampleProgress;
+          double dt = std::chrono::duration<double>(now - sampleFrom).count();
+
+          if (dt > 0)
+          {
+            double sample = (estimate.progress - progressFrom) / dt;
+            item->rate = firstSample ? sample : rateSmoothing * sample + (1 - rateSmoothing) * item->rate;
+            item->lastSampleTime = now;
+            item->lastSampleProgress = estimate.progress;
+          }
+          break;
+        }
+        case S_COMPLETE:
+        case S_CANCELLED:         // No further work will be done.
+        {
+          estimate.progress = 1;
+          item->rate = 0;
+          break;
+        }
+        default:
+        {
+          item->rate = 0;
+          break;
+        }
+      }
+      estimate.rate = item->rate;
+    }
+
+    double etaSeconds = -1;
+    if (item->status == S_COMPLETE || item->status == S_CANCELLED || estimate.progress >= 1)
+    {
+      etaSeconds = 0;
+    }
+    else if (estimate.rate > 0)
+    {
+      etaSeconds = (1 - estimate.progress) / estimate.rate;
+    }
+    changed |= item->etaSeconds.exchange(etaSeconds) != etaSeconds;
+
+    estimates.emplace(item->ID, estimate);
+  }
+
+  if (children.contains(0))
+  {
+    estimate_t overall{0, 0};
+    for (ID_t child: children.at(0))
+    {
+      overall.progress += estimates.at(child).progress;
+      overall.rate += estimates.at(child).rate;
+    }
+    overall.progress /= children.at(0).size();
+    overall.rate /= children.at(0).size();
+
+    double etaSeconds = -1;
+    if (overall.progress >= 1)
+    {
+      etaSeconds = 0;
+    }
+    else if (overall.rate > 0)
+    {
+      etaSeconds = (1 - overall.progress) / overall.rate;
+    }
+    changed |= overallETASeconds.exchange(etaSeconds) != etaSeconds;
+  }
+
+  if (changed)
+  {
+    changeCount++;
+  }
 }
 
 void CProgressGroup::updateProgress(ID_t actionID, updateEvent_e updateEvent, updateVariant_t const *updateData)
@@ -611,6 +1888,21 @@ void CProgressGroup::updateProgress(ID_t actionID, updateEvent_e updateEvent, up
        sl.unlock();
        unique_lock ulAI{actionItem.mActionItem};
        actionItem.progress = p;
+       if (traceEnabled || journal)
+       {
+         clock_type::time_point now = clock_type::now();
+         if (traceEnabled &&
+             (actionItem.progressSamples.empty() || (now - actionItem.progressSamples.back().first) >= traceSampleInterval))
+         {
+           actionItem.progressSamples.emplace_back(now, p);
+         }
+         if (journal && (now - actionItem.lastCheckpoint) >= checkpointInterval)
+         {
+           actionItem.lastCheckpoint = now;
+           journal->append(CProgressJournal::JR_PROGRESS, ID, p);
+         }
+       }
+       changeCount++;
        sUpdateRequired.release();
      }
      else
@@ -623,10 +1915,26 @@ void CProgressGroup::updateProgress(ID_t actionID, updateEvent_e updateEvent, up
 
   void CProgressGroup::updateStep(ID_t ID, std::uint64_t n, std::uint64_t d)
   {
-    updateStep(ID, n/d);
+    shared_lock sl{data.mData};
+
+    if (data.byID.contains(ID))
+    {
+      actionItem_t &actionItem = data.byID.at(ID).get();
+      sl.unlock();
+      unique_lock ulAI{actionItem.mActionItem};
+      actionItem.itemsDone = n;
+    }
+    else
+    {
+      sl.unlock();
+      CODE_ERROR();
+      // Does not return.
+    }
+
+    updateStep(ID, (d == 0) ? 0.0 : static_cast<double>(n) / static_cast<double>(d));
   }
 
-  void CProgressGroup::updateThread()
+  void CProgressGroup::updateThread(std::stop_token stopToken)
   {
     /* Updating requires that updates be rolled up the tree. So any update on any item requires that sections of the tree be
      * recalculated.
@@ -651,39 +1959,36 @@ void CProgressGroup::updateProgress(ID_t actionID, updateEvent_e updateEvent, up
    *    | Thread Group        | Call      | mData  | mActonItem | mModel  | sUpdateRequired |
    *    |---------------------|-----------+--------+------------+---------+-----------------+
    *    | 1. Outside Threads  |   NO      |        |            |         |                 |
-   *    | 2. Update Thread    |  YES      |        |            |         |     aquire()    |
+   *    | 2. Update Thread    |  YES      |        |            |         |     acquire()   |
    *    | 3. GUI Thread       |   NO      |        |            |         |                 |
    *    +---------------------+-----------+--------+------------+---------+-----------------+
    */
 
-    while (terminateThread.test_and_set())
+    while (!stopToken.stop_requested())
     {
-      std::this_thread::sleep_for(std::chrono::seconds(updatePeriod));
-      sUpdateRequired.acquire();
+      if (activeCounters == 0 && attachedSegments == 0)
+      {
+        sUpdateRequired.acquire();
+      }
 
-      shared_lock slData{data.mData};
-      for (auto &node: data.preOrderTree)
+      // Counters and shared memory segments do not signal the update thread, so it polls while any are active. All the changes
+      // signalled while the last pass ran are handled by this pass.
+
+      while (sUpdateRequired.try_acquire())
       {
-        if (node.get().recalcRequired.test_and_set())
-        {
-          node.get().updateRequired.clear();
-          ID_t nodeID = data.byID.at(node.get().ID).get().PID;
+      }
 
-          // Recalculate the parent.
-          std::vector<ID_t> children = data.parentChild.children(nodeID);
-          double progress = 0.0;
-          for (auto const &child: children)
-          {
-            progress += data.byID.at(child).get().progress;
-            if (!data.byID.at(child).get().recalcRequired.test_and_set())      // Children won't force a recalc.
-            {
-              data.byID.at(child).get().updateRequired.clear();
-            }
-          };
-          data.byID.at(nodeID).get().progress.store(progress / children.size());
-          data.byID.at(nodeID).get().recalcRequired.clear();     // Force a recalc of the parent's parent.
-        }
-        Wt::WApplication *application = Wt::WApplication::instance(); // Get this instance.
+      if (!stopToken.stop_requested())
+      {
+        pollSegments();
+        updateEstimates();
+        publishSnapshot();
+        mailbox->post(refreshModel);
+
+        // Limit the updates to one per update period. The wait ends early when a stop is requested.
+
+        std::unique_lock ul{mUpdateWait};
+        cvUpdateWait.wait_for(ul, stopToken, std::chrono::seconds(updatePeriod), []() { return false; });
       }
     }
   }
@@ -0,0 +1,205 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressJournal.cpp
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Append-only journal of progress group step transitions.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/progressJournal.h"
+
+// Standard C++ library header files
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Linux header files
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Miscellaneous library header files
+#include <GCL>
+
+static constexpr std::uint64_t journalMagic = 0x4C4E524A53525057;     // "WPRSJRNL"
+static constexpr std::uint32_t journalVersion = 1;
+
+CProgressJournal::CProgressJournal(std::filesystem::path const &filePath)
+{
+  fileDescriptor = open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  RUNTIME_ASSERT(fileDescriptor != -1, "CProgressJournal: Unable to open journal file.");
+
+  struct stat statBuffer;
+  RUNTIME_ASSERT(fstat(fileDescriptor, &statBuffer) == 0, "CProgressJournal: Unable to stat journal file.");
+
+  if (static_cast<std::size_t>(statBuffer.st_size) < sizeof(header_t))
+  {
+    // New journal.
+
+    resize(initialCapacity);
+    header_t *header = static_cast<header_t *>(mapping);
+    header->version = journalVersion;
+    header->recordSize = sizeof(record_t);
+    header->magic = journalMagic;
+  }
+  else
+  {
+    resize(std::max(initialCapacity, (statBuffer.st_size - sizeof(header_t)) / sizeof(record_t)));
+    header_t const *header = static_cast<header_t const *>(mapping);
+    RUNTIME_ASSERT(header->magic == journalMagic && header->version == journalVersion && header->recordSize == sizeof(record_t),
+                   "CProgressJournal: File is not a progress journal.");
+
+    // Find the end of the journal. This is the first record that is empty or torn.
+
+    record_t const *record = records();
+    while (recordCount != capacity && record[recordCount].type != JR_NONE &&
+           record[recordCount].checksum == checksum(record[recordCount]))
+    {
+      recordCount++;
+    }
+  }
+}
+
+CProgressJournal::~CProgressJournal()
+{
+  if (mapping != nullptr)
+  {
+    munmap(mapping, sizeof(header_t) + capacity * sizeof(record_t));
+  }
+  if (fileDescriptor != -1)
+  {
+    close(fileDescriptor);
+  }
+}
+
+void CProgressJournal::append(recordType_e type, ID_t actionID, double value)
+{
+  record_t record;
+  record.type = type;
+  record.ID = actionID;
+  record.value = value;
+  record.time = std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::system_clock::now().time_since_epoch()).count();
+  record.checksum = checksum(record);
+
+  std::lock_guard lg{mJournal};
+
+  if (recordCount == capacity)
+  {
+    resize(capacity * 2);
+  }
+  std::memcpy(&records()[recordCount++], &record, sizeof(record_t));
+}
+
+std::uint32_t CProgressJournal::checksum(record_t const &record) noexcept
+{
+  // FNV-1a over the record, excluding the checksum field.
+
+  std::uint32_t hash = 2166136261U;
+  auto hashBytes = [&hash](void const *data, std::size_t length)
+  {
+    for (std::size_t index = 0; index != length; index++)
+    {
+      hash = (hash ^ static_cast<unsigned char const *>(data)[index]) * 16777619U;
+    }
+  };
+
+  hashBytes(&record.type, sizeof(record.type));
+  hashBytes(&record.ID, sizeof(record.ID));
+  hashBytes(&record.value, sizeof(record.value));
+  hashBytes(&record.time, sizeof(record.time));
+
+  return hash;
+}
+
+void CProgressJournal::flush()
+{
+  std::lock_guard lg{mJournal};
+
+  msync(mapping, sizeof(header_t) + recordCount * sizeof(record_t), MS_SYNC);
+}
+
+CProgressJournal::record_t *CProgressJournal::records() const noexcept
+{
+  return reinterpret_cast<record_t *>(static_cast<char *>(mapping) + sizeof(header_t));
+}
+
+void CProgressJournal::replay(replay_f const &replayFunction) const
+{
+  std::unique_lock ul{mJournal};
+  std::size_t count = recordCount;
+  ul.unlock();
+
+  // Records below count are never rewritten, so they can be read without the lock. The mapping is only replaced while appending,
+  // which must not happen during a replay.
+
+  record_t const *record = records();
+  for (std::size_t index = 0; index != count; index++)
+  {
+    replayFunction(record[index]);
+  }
+}
+
+void CProgressJournal::reset()
+{
+  std::lock_guard lg{mJournal};
+
+  // Truncating to the header and regrowing zero fills the records.
+
+  RUNTIME_ASSERT(ftruncate(fileDescriptor, sizeof(header_t)) == 0, "CProgressJournal: Unable to truncate journal file.");
+  RUNTIME_ASSERT(ftruncate(fileDescriptor, sizeof(header_t) + capacity * sizeof(record_t)) == 0,
+                 "CProgressJournal: Unable to size journal file.");
+  recordCount = 0;
+}
+
+void CProgressJournal::resize(std::size_t newCapacity)
+{
+  std::size_t oldSize = sizeof(header_t) + capacity * sizeof(record_t);
+  std::size_t newSize = sizeof(header_t) + newCapacity * sizeof(record_t);
+
+  RUNTIME_ASSERT(ftruncate(fileDescriptor, newSize) == 0, "CProgressJournal: Unable to size journal file.");
+
+  void *newMapping;
+  if (mapping == nullptr)
+  {
+    newMapping = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+  }
+  else
+  {
+    newMapping = mremap(mapping, oldSize, newSize, MREMAP_MAYMOVE);
+  }
+  RUNTIME_ASSERT(newMapping != MAP_FAILED, "CProgressJournal: Unable to map journal file.");
+
+  mapping = newMapping;
+  capacity = newCapacity;
+}
+
+std::size_t CProgressJournal::size() const
+{
+  std::lock_guard lg{mJournal};
+
+  return recordCount;
+}
@@ -0,0 +1,88 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressResource.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Resource that serves the state of a CProgressGroup as JSON.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/progressResource.h"
+
+// Standard C++ library header files
+#include <charconv>
+
+// Miscellaneous libraries
+#include <fmt/format.h>
+
+/* Multi-threading
+ * handleRequest() may be called concurrently from the server threads. The snapshot is immutable once published, so no locks are
+ * held while the response is written.
+ */
+
+CProgressResource::CProgressResource(CProgressGroup const &pg) : progressGroup(pg)
+{
+}
+
+CProgressResource::~CProgressResource()
+{
+  beingDeleted();
+}
+
+void CProgressResource::handleRequest(Wt::Http::Request const &request, Wt::Http::Response &response)
+{
+  std::shared_ptr<CProgressGroup::snapshot_t const> snapshot = progressGroup.snapshot();
+  std::string eTag = fmt::format("\"{:x}-{}\"", snapshot->epoch, snapshot->version);
+
+  // The since parameter is "<epoch>-<version>". A version from another epoch (an earlier group or process) is ignored, and all
+  // the items are returned.
+
+  std::uint64_t since = 0;
+  if (std::string const *parameter = request.getParameter("since"))
+  {
+    char const *end = parameter->data() + parameter->size();
+    std::uint64_t epoch = 0;
+    std::uint64_t version = 0;
+    auto [epochEnd, epochError] = std::from_chars(parameter->data(), end, epoch, 16);
+
+    if (epochError == std::errc() && epochEnd != end && *epochEnd == '-' && epoch == snapshot->epoch &&
+        std::from_chars(epochEnd + 1, end, version).ec == std::errc())
+    {
+      since = version;
+    }
+  }
+
+  response.addHeader("ETag", eTag);
+  response.addHeader("Cache-Control", "no-cache");
+
+  if (request.headerValue("If-None-Match") == eTag || since >= snapshot->version)
+  {
+    response.setStatus(304);
+  }
+  else
+  {
+    response.setMimeType("application/json");
+    CProgressGroup::exportSnapshot(response.out(), *snapshot, since);
+  }
+}
@@ -0,0 +1,198 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                progressSegment.cpp
+// LANGUAGE:            C++
+// TARGET OS:           Linux.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Shared memory segment used to report progress from other processes.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/progressSegment.h"
+
+// Standard C++ library header files
+#include <algorithm>
+
+// Linux header files
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Miscellaneous library header files
+#include <GCL>
+
+static constexpr std::uint64_t segmentMagic = 0x5754505347534547;     // "WTPSGSEG"
+
+CProgressSegment::CProgressSegment(std::size_t slotCount)
+{
+  RUNTIME_ASSERT(slotCount != 0, "CProgressSegment: Slot count must be non-zero.");
+
+  fileDescriptor = memfd_create("WtExtensions-progress", MFD_CLOEXEC);
+  RUNTIME_ASSERT(fileDescriptor != -1, "CProgressSegment: Unable to create shared memory.");
+
+  mappedSize = sizeof(sharedHeader_t) + slotCount * sizeof(sharedSlot_t);
+  RUNTIME_ASSERT(ftruncate(fileDescriptor, mappedSize) == 0, "CProgressSegment: Unable to size shared memory.");
+
+  map();
+
+  // The memfd is zero filled, so the atomics start at zero. Only the header needs to be written.
+
+  header->slotCount = slotCount;
+  header->magic = segmentMagic;
+  seen.resize(slotCount);
+}
+
+CProgressSegment::CProgressSegment(attach_t, int fd) : fileDescriptor(fd)
+{
+  struct stat statBuffer;
+
+  RUNTIME_ASSERT(fstat(fileDescriptor, &statBuffer) == 0, "CProgressSegment: Unable to stat shared memory.");
+  RUNTIME_ASSERT(static_cast<std::size_t>(statBuffer.st_size) >= sizeof(sharedHeader_t),
+                 "CProgressSegment: Descriptor is not a progress segment.");
+  mappedSize = statBuffer.st_size;
+
+  map();
+
+  RUNTIME_ASSERT(header->magic == segmentMagic, "CProgressSegment: Descriptor is not a progress segment.");
+  RUNTIME_ASSERT(mappedSize >= sizeof(sharedHeader_t) + header->slotCount * sizeof(sharedSlot_t),
+                 "CProgressSegment: Segment is truncated.");
+  seen.resize(header->slotCount);
+}
+
+CProgressSegment::~CProgressSegment()
+{
+  if (header != nullptr)
+  {
+    munmap(header, mappedSize);
+  }
+  if (fileDescriptor != -1)
+  {
+    close(fileDescriptor);
+  }
+}
+
+CProgressSegment::slot_t CProgressSegment::acquireSlot(ID_t actionID)
+{
+  slot_t slot = header->nextSlot.fetch_add(1, std::memory_order_relaxed) % header->slotCount;
+  std::size_t searched = 0;
+  std::uint64_t expected = 0;
+
+  // Search the ring for a free slot, starting after the last slot claimed.
+
+  while (!slots[slot].inUse.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+  {
+    expected = 0;
+    searched++;
+    RUNTIME_ASSERT(searched < header->slotCount, "CProgressSegment: All the slots are in use.");
+    slot = (slot + 1) % header->slotCount;
+  }
+
+  writeSlot(slot, [actionID](sharedSlot_t &s)
+  {
+    s.ID.store(actionID, std::memory_order_relaxed);
+    s.num.store(0, std::memory_order_relaxed);
+    s.denom.store(0, std::memory_order_relaxed);
+    s.flags.store(0, std::memory_order_relaxed);
+  });
+
+  return slot;
+}
+
+void CProgressSegment::beginStep(slot_t slot) noexcept
+{
+  writeSlot(slot, [](sharedSlot_t &s)
+  {
+    s.flags.store(s.flags.load(std::memory_order_relaxed) | SF_BEGUN, std::memory_order_relaxed);
+  });
+}
+
+void CProgressSegment::completeStep(slot_t slot) noexcept
+{
+  writeSlot(slot, [](sharedSlot_t &s)
+  {
+    s.flags.store(s.flags.load(std::memory_order_relaxed) | SF_BEGUN | SF_COMPLETE, std::memory_order_relaxed);
+  });
+}
+
+void CProgressSegment::map()
+{
+  void *address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+  RUNTIME_ASSERT(address != MAP_FAILED, "CProgressSegment: Unable to map shared memory.");
+
+  header = static_cast<sharedHeader_t *>(address);
+  slots = reinterpret_cast<sharedSlot_t *>(static_cast<char *>(address) + sizeof(sharedHeader_t));
+}
+
+void CProgressSegment::poll(poll_f const &pollFunction)
+{
+  for (slot_t slot = 0; slot != seen.size(); slot++)
+  {
+    sharedSlot_t &s = slots[slot];
+    std::uint64_t sequence = s.sequence.load(std::memory_order_acquire);
+
+    if (sequence == 0 || (sequence & 1) != 0 || sequence == seen[slot].sequence)
+    {
+      // Not yet written, being written, or unchanged.
+      continue;
+    }
+
+    sample_t sample;
+    sample.ID = s.ID.load(std::memory_order_relaxed);
+    sample.num = s.num.load(std::memory_order_relaxed);
+    sample.denom = s.denom.load(std::memory_order_relaxed);
+    std::uint64_t flags = s.flags.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.sequence.load(std::memory_order_relaxed) != sequence)
+    {
+      // Written while being read. Pick it up on the next poll.
+      continue;
+    }
+
+    sample.begun = (flags & SF_BEGUN) != 0 && (seen[slot].flags & SF_BEGUN) == 0;
+    sample.completed = (flags & SF_COMPLETE) != 0 && (seen[slot].flags & SF_COMPLETE) == 0;
+    seen[slot].sequence = sequence;
+    seen[slot].flags = flags;
+
+    if ((flags & SF_COMPLETE) != 0)
+    {
+      // The writer has finished with the slot. Reset the reader state so that the next claim is seen from the beginning, and free
+      // the slot.
+
+      seen[slot].flags = 0;
+      s.inUse.store(0, std::memory_order_release);
+    }
+
+    pollFunction(sample);
+  }
+}
+
+void CProgressSegment::updateStep(slot_t slot, std::uint64_t num, std::uint64_t denom) noexcept
+{
+  writeSlot(slot, [num, denom](sharedSlot_t &s)
+  {
+    s.num.store(num, std::memory_order_relaxed);
+    s.denom.store(denom, std::memory_order_relaxed);
+  });
+}
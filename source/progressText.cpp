@@ -39,27 +39,47 @@
 #include <web/DomElement.h>
 #include <Wt/WString.h>
 
-CProgressText::CProgressText() : std::ostream(this), Wt::WText(), app(Wt::WApplication::instance())
+CProgressText::CProgressText() : std::ostream(this), Wt::WText(),
+  CPullMode(*this, CUpdateMailbox::instance(*Wt::WApplication::instance())), app(Wt::WApplication::instance())
   {
     setTextFormat(Wt::TextFormat::Plain);
     setStyleClass("textarea");
-    app->enableUpdates(true);
   }
 
-std::streambuf::int_type CProgressText::overflow(int ch)
+void CProgressText::applyPending()
 {
-  Wt::WApplication::UpdateLock uiLock(app);
+  std::string text;
+
+  {
+    std::lock_guard lg{mPending};
+    std::swap(text, pendingText);
+  }
+
+  if (!text.empty())
+  {
+    setText(this->text() + text);
+    doJavaScript(jsRef() + ".scrollTop = "+ jsRef() + ".scrollHeight;");
+  }
+}
 
-  if (uiLock)
+std::streambuf::int_type CProgressText::overflow(int ch)
+{
+  if (ch != Traits::eof())
   {
-    if (ch != Traits::eof())
+    bool wasEmpty;
+
     {
-      setText(text() + std::string{static_cast<char>(ch)});
-      doJavaScript(jsRef() + ".scrollTop = "+ jsRef() + ".scrollHeight;");
-      app->triggerUpdate();
-      return 0;
-    };
-  };
+      std::lock_guard lg{mPending};
+      wasEmpty = pendingText.empty();
+      pendingText.push_back(static_cast<char>(ch));
+    }
+
+    if (wasEmpty && !pullMode)
+    {
+      mailbox->post(applyClosure);
+    }
+  }
+  return 0;
 }
 
 void CProgressText::updateDom(Wt::DomElement& element, bool all)
@@ -0,0 +1,78 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                pullMode.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Pull mode support for widgets that are updated from outside the GUI thread.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+
+#include "include/pullMode.h"
+
+CPullMode::CPullMode(Wt::WObject &o, std::shared_ptr<CUpdateMailbox> mb) : mailbox(std::move(mb)),
+  applyClosure(o.bindSafe([this]() { applyPending(); })), owner(o)
+{
+  mailbox->requirePush(true);
+}
+
+CPullMode::~CPullMode()
+{
+  if (!pullMode)
+  {
+    mailbox->requirePush(false);
+  }
+}
+
+void CPullMode::setPullMode(std::chrono::milliseconds interval)
+{
+  if (interval.count() == 0)
+  {
+    if (pullMode)
+    {
+      pullMode = false;
+      mailbox->requirePush(true);
+    }
+    if (pullTimer)
+    {
+      pullTimer->stop();
+    }
+    applyPending();
+  }
+  else
+  {
+    if (!pullTimer)
+    {
+      pullTimer = owner.addChild(std::make_unique<Wt::WTimer>());
+      pullTimer->timeout().connect([this]() { applyPending(); });
+    }
+    pullTimer->setInterval(interval);
+    pullTimer->start();
+    if (!pullMode)
+    {
+      pullMode = true;
+      mailbox->requirePush(false);
+    }
+  }
+}
@@ -31,6 +31,7 @@
 #include "include/requirementsWidget.h"
 
 // Standard C++ library headers
+#include <algorithm>
 #include <functional>
 #include <list>
 
@@ -266,15 +267,29 @@ private:
 /// @throws
 /// @version    2024-03-15/GGB - Function created.
 
-CRequirementsWidget::CRequirementsWidget(Wt::WApplication &a) : application(a)
+CRequirementsWidget::CRequirementsWidget(Wt::WApplication &a) : CPullMode(*this, CUpdateMailbox::instance(a)), application(a)
 {
-  model = std::make_shared<CRequirementsModel>();
-  createUI();
 }
 
 bool CRequirementsWidget::allMet() const noexcept
 {
-  return std::dynamic_pointer_cast<CRequirementsModel>(model)->allMet();
+  bool rv = true;
+
+  if (model)
+  {
+    rv = std::dynamic_pointer_cast<CRequirementsModel>(model)->allMet();
+  }
+  else
+  {
+    for (auto const &record: pendingRecords)
+    {
+      if (record.requirementType == REQUIRED)
+      {
+        rv = rv && record.available;
+      }
+    }
+  }
+  return rv;
 }
 
 /// @brief      Sets up the UI aspects of the widget.
@@ -283,6 +298,19 @@ bool CRequirementsWidget::allMet() const noexcept
 
 void CRequirementsWidget::createUI()
 {
+  std::shared_ptr<CRequirementsModel> requirementsModel = std::make_shared<CRequirementsModel>();
+
+  for (auto &record: pendingRecords)
+  {
+    requirementsModel->setData(record.ID, std::move(record.shortText), record.requirementType);
+    if (record.available)
+    {
+      requirementsModel->changeStatus(record.ID, true);
+    }
+  }
+  pendingRecords.clear();
+  model = requirementsModel;
+
   setLayoutSizeAware(true);
   setOverflow(Wt::Overflow::Scroll);
 
@@ -295,6 +323,44 @@ void CRequirementsWidget::createUI()
   setEditTriggers(Wt::EditTrigger::None);
 }
 
+/// @brief      Applies the recorded status changes.
+/// @throws
+
+void CRequirementsWidget::applyPending()
+{
+  std::map<ID_t, bool> status;
+
+  {
+    std::lock_guard lg{mPending};
+    std::swap(status, pendingStatus);
+  }
+
+  for (auto const &[ID, enable]: status)
+  {
+    applyStatus(ID, enable);
+  }
+}
+
+/// @brief      Changes the status of a requirement in the model, or in the pending list if the model has not been created.
+/// @param[in]  ID: The requirement to change.
+/// @param[in]  enable: The status.
+/// @throws     RUNTIME_ASSERT
+
+void CRequirementsWidget::applyStatus(ID_t ID, bool enable)
+{
+  if (model)
+  {
+    std::dynamic_pointer_cast<CRequirementsModel>(model)->changeStatus(ID, enable);
+  }
+  else
+  {
+    auto iter = std::find_if(pendingRecords.begin(), pendingRecords.end(),
+                             [ID](pendingRecord_t const &record) { return record.ID == ID; });
+    RUNTIME_ASSERT(iter != pendingRecords.end(), "CRequirementsWidget::changeStatus: Requirement does not exist.");
+    iter->available = enable;
+  }
+}
+
 /// @brief      Change the enabled status of the specified items.
 /// @param[in]  ID: The item to update
 /// @param[in]  enable: The desired status.
@@ -303,19 +369,24 @@ void CRequirementsWidget::changeStatus(ID_t ID, bool enable)
 {
   if (Wt::WApplication::instance() == nullptr)
   {
-    // Not in GUI thread.
-    Wt::WApplication::UpdateLock uiLock(&application);
+    // Not in GUI thread. Only the latest status of each requirement needs to be kept.
+    bool wasEmpty;
 
-    if (uiLock)
     {
-      std::dynamic_pointer_cast<CRequirementsModel>(model)->changeStatus(ID, enable);
-    };
-    application.triggerUpdate();
+      std::lock_guard lg{mPending};
+      wasEmpty = pendingStatus.empty();
+      pendingStatus[ID] = enable;
+    }
+
+    if (wasEmpty && !pullMode)
+    {
+      mailbox->post(applyClosure);
+    }
   }
   else
   {
     // IN GUI thread.
-    std::dynamic_pointer_cast<CRequirementsModel>(model)->changeStatus(ID, enable);
+    applyStatus(ID, enable);
   };
 
 }
@@ -329,8 +400,14 @@ void CRequirementsWidget::changeStatus(ID_t ID, bool enable)
 
 void CRequirementsWidget::insert(ID_t id, std::string &&txt, requirementType_e rt)
 {
-  std::dynamic_pointer_cast<CRequirementsModel>(model)->setData(id, std::move(txt), rt);
-
+  if (model)
+  {
+    std::dynamic_pointer_cast<CRequirementsModel>(model)->setData(id, std::move(txt), rt);
+  }
+  else
+  {
+    pendingRecords.emplace_back(id, std::move(txt), rt);
+  }
 }
 
 /// @brief      Inserts a new item into the model.
@@ -341,7 +418,14 @@ void CRequirementsWidget::insert(ID_t id, std::string &&txt, requirementType_e r
 
 void CRequirementsWidget::insert(ID_t id, std::string const &txt, requirementType_e rt)
 {
-  std::dynamic_pointer_cast<CRequirementsModel>(model)->setData(id, txt, rt);
+  if (model)
+  {
+    std::dynamic_pointer_cast<CRequirementsModel>(model)->setData(id, txt, rt);
+  }
+  else
+  {
+    pendingRecords.emplace_back(id, txt, rt);
+  }
 }
 
 /// @brief      Inserts a list of items into the model.
@@ -354,12 +438,33 @@ void CRequirementsWidget::insert(std::initializer_list<std::tuple<ID_t, std::str
 {
   for (auto i : il)
   {
-    std::dynamic_pointer_cast<CRequirementsModel>(model)->setData(std::get<0>(i), std::get<1>(i), std::get<2>(i));
+    insert(std::get<0>(i), std::get<1>(i), std::get<2>(i));
   }
 }
 
-void CRequirementsWidget::resetAll() noexcept
+/// @brief      Creates the UI on the first render.
+/// @param[in]  flags: The render flags.
+
+void CRequirementsWidget::render(Wt::WFlags<Wt::RenderFlag> flags)
 {
-  std::dynamic_pointer_cast<CRequirementsModel>(model)->resetAll();
+  if (!model)
+  {
+    createUI();
+  }
+  Wt::WTableView::render(flags);
 }
 
+void CRequirementsWidget::resetAll() noexcept
+{
+  if (model)
+  {
+    std::dynamic_pointer_cast<CRequirementsModel>(model)->resetAll();
+  }
+  else
+  {
+    for (auto &record: pendingRecords)
+    {
+      record.available = false;
+    }
+  }
+}
@@ -0,0 +1,62 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                spoolReader.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Reads the data appended to a spool file while it is being uploaded.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/spoolReader.h"
+
+// Standard C++ library header files
+#include <vector>
+
+std::uint64_t CSpoolReader::read(read_f const &readFunction)
+{
+  std::uint64_t rv = 0;
+
+  if (!input.is_open())
+  {
+    input.open(spoolFile_, std::ios::binary);
+  }
+
+  if (input.is_open())
+  {
+    // A previous read may have stopped at the end of the file, so the stream state is cleared before reading the new data.
+
+    std::vector<char> buffer(blockSize);
+
+    input.clear();
+    input.seekg(position_);
+    while (input.read(buffer.data(), buffer.size()) || input.gcount() != 0)
+    {
+      std::size_t count = static_cast<std::size_t>(input.gcount());
+      readFunction(std::span<char const>(buffer.data(), count));
+      position_ += count;
+      rv += count;
+    }
+  }
+  return rv;
+}
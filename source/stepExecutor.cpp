@@ -0,0 +1,325 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                stepExecutor.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Executes the steps of a CProgressGroup in parallel.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/stepExecutor.h"
+
+// Miscellaneous library header files
+#include <GCL>
+
+/* Multi-threading
+ * All the step state is protected by mSteps. The step functions are called from the thread pool without the lock held. The
+ * progress group calls (beginStep, completeStep) are made with mSteps held, except that a step with a function is begun by
+ * execute() on the worker thread, so that the group measures the CPU time of the thread that does the work. The progress group
+ * never calls into the executor so there is no lock ordering issue.
+ *
+ * Stages are begun without measuring the CPU time, as their children run on other threads and are already counted in the tree.
+ * The CPU time of a stage's own function is measured by execute().
+ */
+
+CStepExecutor::CStepExecutor(CProgressGroup &pg, CThreadPool &tp, std::size_t mc)
+  : progressGroup(pg), threadPool(tp), maxConcurrent(mc == 0 ? tp.size() : mc)
+{
+}
+
+void CStepExecutor::addDependency(ID_t stepID, ID_t dependsOn)
+{
+  std::lock_guard lg{mSteps};
+
+  steps.at(stepID).dependsOn.push_back(dependsOn);
+}
+
+void CStepExecutor::addStep(ID_t stepID, step_f stepFunction, std::initializer_list<ID_t> dependsOn)
+{
+  std::lock_guard lg{mSteps};
+
+  if (steps.contains(stepID))
+  {
+    CODE_ERROR();
+    // Does not return.
+  }
+
+  step_t &step = steps[stepID];
+  step.ID = stepID;
+  step.stepFunction = std::move(stepFunction);
+  step.dependsOn.assign(dependsOn.begin(), dependsOn.end());
+}
+
+void CStepExecutor::checkReady(step_t &step)
+{
+  if (step.status == SS_WAITING && step.unmetDependencies == 0 &&
+      (step.parent == 0 || (steps.at(step.parent).status != SS_WAITING && steps.at(step.parent).status != SS_READY)))
+  {
+    step.status = SS_READY;
+    readyQueue.push_back(step.ID);
+  }
+}
+
+void CStepExecutor::dispatch()
+{
+  /* Starting a step can add steps to the ready queue, so the queue is rescanned from the front after each step is started. */
+
+  bool stepStarted = true;
+
+  while (!exception && stepStarted)
+  {
+    stepStarted = false;
+
+    for (auto iter = readyQueue.begin(); iter != readyQueue.end(); iter++)
+    {
+      step_t &step = steps.at(*iter);
+      bool cancelled = progressGroup.stopToken(step.ID).stop_requested();
+      bool complete = (progressGroup.stepStatus(step.ID) == CProgressGroup::S_COMPLETE);
+
+      if (step.status == SS_READY && !step.children.empty())
+      {
+        // Stage. Begin it and release the children. Stages do not count against the concurrency limit.
+        // If the stage is cancelled, the children are cancelled and will finish without running.
+
+        readyQueue.erase(iter);
+        if (cancelled)
+        {
+          progressGroup.cancelSubtree(step.ID);
+        }
+        else if (!complete)
+        {
+          progressGroup.beginStep(step.ID, false);
+        }
+        step.status = SS_BEGUN;
+        for (ID_t child: step.children)
+        {
+          checkReady(steps.at(child));
+        }
+      }
+      else if (cancelled)
+      {
+        readyQueue.erase(iter);
+        finish(step, true);
+      }
+      else if (complete)
+      {
+        // Already complete. (Restored from a journal.)
+
+        readyQueue.erase(iter);
+        finish(step);
+      }
+      else if (!step.stepFunction)
+      {
+        readyQueue.erase(iter);
+        if (step.status == SS_READY)
+        {
+          progressGroup.beginStep(step.ID);
+        }
+        finish(step);
+      }
+      else if (running < maxConcurrent)
+      {
+        readyQueue.erase(iter);
+        step.status = SS_RUNNING;
+        running++;
+        threadPool.submit([this, ID = step.ID] { execute(ID); });
+      }
+      else
+      {
+        continue;
+      }
+
+      stepStarted = true;
+      break;
+    }
+  }
+}
+
+void CStepExecutor::execute(ID_t stepID)
+{
+  std::unique_lock ul{mSteps};
+  step_t &step = steps.at(stepID);
+  bool stage = !step.children.empty();
+  ul.unlock();
+
+  if (stage)
+  {
+    progressGroup.measureCPU(stepID);
+  }
+  else
+  {
+    progressGroup.beginStep(stepID);
+  }
+
+  std::stop_token stopToken = progressGroup.stopToken(stepID);
+  std::exception_ptr stepException;
+  try
+  {
+    step.stepFunction(stopToken);
+  }
+  catch(...)
+  {
+    stepException = std::current_exception();
+  }
+
+  ul.lock();
+  running--;
+  if (stepException)
+  {
+    // The step is shown as cancelled, so that it does not remain active in the tree.
+
+    progressGroup.cancelStep(stepID);
+    if (!exception)
+    {
+      exception = stepException;
+    }
+  }
+  else
+  {
+    finish(step, stopToken.stop_requested());
+  }
+  dispatch();
+  ul.unlock();
+
+  cvComplete.notify_all();
+}
+
+void CStepExecutor::finish(step_t &step, bool cancelled)
+{
+  if (cancelled)
+  {
+    progressGroup.cancelStep(step.ID);
+  }
+  else
+  {
+    progressGroup.completeStep(step.ID);
+  }
+  step.status = SS_COMPLETE;
+  completed++;
+
+  for (ID_t dependentID: step.dependents)
+  {
+    step_t &dependent = steps.at(dependentID);
+    if (cancelled)
+    {
+      progressGroup.cancelSubtree(dependentID);
+    }
+    dependent.unmetDependencies--;
+    checkReady(dependent);
+  }
+
+  if (step.parent != 0)
+  {
+    step_t &parent = steps.at(step.parent);
+    if (--parent.childrenRemaining == 0)
+    {
+      // All the children of the stage are complete. Run the stage's own function, if any.
+
+      if (parent.stepFunction)
+      {
+        readyQueue.push_front(parent.ID);
+      }
+      else
+      {
+        finish(parent, progressGroup.stopToken(parent.ID).stop_requested());
+      }
+    }
+  }
+}
+
+void CStepExecutor::run()
+{
+  std::unique_lock ul{mSteps};
+
+  // Build the tree and dependency edges.
+
+  for (auto &[ID, step]: steps)
+  {
+    step.parent = 0;
+    step.children.clear();
+    step.dependents.clear();
+    step.status = SS_WAITING;
+  }
+
+  for (auto &[ID, step]: steps)
+  {
+    // Find the nearest ancestor in the plan.
+
+    for (ID_t PID = progressGroup.parentID(ID); PID != 0; PID = progressGroup.parentID(PID))
+    {
+      if (steps.contains(PID))
+      {
+        step.parent = PID;
+        steps.at(PID).children.push_back(ID);
+        break;
+      }
+    }
+
+    for (ID_t dependsOn: step.dependsOn)
+    {
+      RUNTIME_ASSERT(steps.contains(dependsOn), "CStepExecutor::run: Dependency is not in the plan.");
+      steps.at(dependsOn).dependents.push_back(ID);
+    }
+    step.unmetDependencies = step.dependsOn.size();
+  }
+
+  for (auto &[ID, step]: steps)
+  {
+    step.childrenRemaining = step.children.size();
+  }
+
+  readyQueue.clear();
+  running = 0;
+  completed = 0;
+  exception = nullptr;
+
+  for (auto &[ID, step]: steps)
+  {
+    checkReady(step);
+  }
+  dispatch();
+
+  cvComplete.wait(ul, [this]
+  {
+    return completed == steps.size() || (running == 0 && (exception || readyQueue.empty()));
+  });
+
+  // If a step threw or the dependencies contain a cycle, the stages that were begun are cancelled rather than left active.
+
+  for (auto &[ID, step]: steps)
+  {
+    if (step.status == SS_BEGUN)
+    {
+      progressGroup.cancelStep(ID);
+      step.status = SS_COMPLETE;
+    }
+  }
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+
+  RUNTIME_ASSERT(completed == steps.size(), "CStepExecutor::run: The dependencies contain a cycle.");
+}
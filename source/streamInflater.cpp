@@ -0,0 +1,94 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                streamInflater.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Decompresses a gzip stream into a file.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/streamInflater.h"
+
+// Standard C++ library header files
+#include <array>
+
+// Miscellaneous library header files
+#include <GCL>
+
+CStreamInflater::CStreamInflater(std::filesystem::path const &outputFile, output_f outputFunction)
+  : output(outputFile, std::ios::binary | std::ios::trunc), outputFunction_(std::move(outputFunction))
+{
+  // 16 + MAX_WBITS: gzip header and trailer.
+
+  RUNTIME_ASSERT(inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK, "CStreamInflater: Unable to initialise inflater.");
+  RUNTIME_ASSERT(output.is_open(), "CStreamInflater: Unable to open output file.");
+}
+
+CStreamInflater::~CStreamInflater()
+{
+  inflateEnd(&stream);
+}
+
+bool CStreamInflater::finish()
+{
+  output.close();
+  return !failed_ && memberComplete && output;
+}
+
+void CStreamInflater::write(std::span<char const> data)
+{
+  std::array<char, blockSize> buffer;
+
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+
+  while (!failed_ && stream.avail_in != 0)
+  {
+    stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    memberComplete = false;
+
+    int result = inflate(&stream, Z_NO_FLUSH);
+
+    std::size_t count = buffer.size() - stream.avail_out;
+    output.write(buffer.data(), count);
+    if (outputFunction_ && count != 0)
+    {
+      outputFunction_(std::span<char const>(buffer.data(), count));
+    }
+    size_ += count;
+
+    if (result == Z_STREAM_END)
+    {
+      // The next member, if any, starts with a new header.
+
+      memberComplete = true;
+      inflateReset(&stream);
+    }
+    else if (result != Z_OK && result != Z_BUF_ERROR)
+    {
+      failed_ = true;
+    }
+  }
+}
@@ -0,0 +1,146 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                threadPool.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Work-stealing thread pool.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/threadPool.h"
+
+// Standard C++ library header files
+#include <algorithm>
+
+// Identifies the pool and queue of the current worker thread. Used to push tasks submitted from a worker onto its own queue.
+
+static thread_local CThreadPool const *currentPool = nullptr;
+static thread_local std::size_t currentIndex = 0;
+
+CThreadPool::CThreadPool(std::size_t threadCount)
+{
+  if (threadCount == 0)
+  {
+    threadCount = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  for (std::size_t index = 0; index != threadCount; index++)
+  {
+    queues.emplace_back(std::make_unique<queue_t>());
+  }
+  for (std::size_t index = 0; index != threadCount; index++)
+  {
+    threads.emplace_back(&CThreadPool::workerThread, this, index);
+  }
+}
+
+CThreadPool::~CThreadPool()
+{
+  {
+    std::lock_guard lg{mWake};
+    terminateThreads = true;
+  }
+  cvWake.notify_all();
+
+  for (auto &thread: threads)
+  {
+    thread.join();
+  }
+}
+
+bool CThreadPool::popTask(std::size_t index, task_type &task)
+{
+  {
+    std::lock_guard lg{queues[index]->mQueue};
+    if (!queues[index]->tasks.empty())
+    {
+      task = std::move(queues[index]->tasks.back());
+      queues[index]->tasks.pop_back();
+      return true;
+    }
+  }
+
+  for (std::size_t offset = 1; offset != queues.size(); offset++)
+  {
+    queue_t &victim = *queues[(index + offset) % queues.size()];
+    std::lock_guard lg{victim.mQueue};
+    if (!victim.tasks.empty())
+    {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void CThreadPool::submit(task_type task)
+{
+  std::size_t index = (currentPool == this) ? currentIndex : nextQueue++ % queues.size();
+
+  // The count is incremented before the task is queued, so that a worker can never pop the task and decrement the count first.
+
+  {
+    std::lock_guard lg{mWake};
+    pendingTasks++;
+  }
+  {
+    std::lock_guard lg{queues[index]->mQueue};
+    queues[index]->tasks.push_back(std::move(task));
+  }
+  cvWake.notify_one();
+}
+
+void CThreadPool::workerThread(std::size_t index)
+{
+  currentPool = this;
+  currentIndex = index;
+
+  while (true)
+  {
+    {
+      std::unique_lock ul{mWake};
+      cvWake.wait(ul, [this] { return pendingTasks != 0 || terminateThreads; });
+      if (pendingTasks == 0 && terminateThreads)
+      {
+        break;
+      }
+    }
+
+    task_type task;
+    if (popTask(index, task))
+    {
+      pendingTasks--;
+      task();
+    }
+    else
+    {
+      // Another worker took the task between the wake and the pop.
+      std::this_thread::yield();
+    }
+  }
+
+  currentPool = nullptr;
+}
@@ -0,0 +1,220 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                updateMailbox.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Per-application mailbox that applies UI updates from worker threads in a single pass.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/updateMailbox.h"
+
+// Standard C++ library header files
+#include <map>
+
+// Wt++ header files
+#include <Wt/WObject.h>
+#include <Wt/WServer.h>
+
+// Miscellaneous library header files
+#include <GCL>
+
+/* The registry maps each application to its mailbox. A guard object is added as a child of the application. When the
+ * application is destroyed, the guard closes the mailbox and removes it from the registry.
+ */
+
+static std::mutex mRegistry;
+static std::map<Wt::WApplication const *, std::shared_ptr<CUpdateMailbox>> registry;
+
+class CUpdateMailboxGuard : public Wt::WObject
+{
+public:
+  CUpdateMailboxGuard(Wt::WApplication const *a, std::shared_ptr<CUpdateMailbox> mb) : application(a), mailbox(std::move(mb)) {}
+  virtual ~CUpdateMailboxGuard()
+  {
+    mailbox->close();
+
+    std::lock_guard lg{mRegistry};
+    registry.erase(application);
+  }
+
+private:
+  CUpdateMailboxGuard() = delete;
+  CUpdateMailboxGuard(CUpdateMailboxGuard const &) = delete;
+  CUpdateMailboxGuard(CUpdateMailboxGuard &&) = delete;
+  CUpdateMailboxGuard &operator=(CUpdateMailboxGuard const &) = delete;
+  CUpdateMailboxGuard &operator=(CUpdateMailboxGuard &&) = delete;
+
+  Wt::WApplication const *application;
+  std::shared_ptr<CUpdateMailbox> mailbox;
+};
+
+CUpdateMailbox::CUpdateMailbox(Wt::WApplication &a) : application(a)
+{
+}
+
+void CUpdateMailbox::close()
+{
+  std::lock_guard lg{mMailbox};
+
+  closed = true;
+  closures.clear();
+}
+
+void CUpdateMailbox::drain()
+{
+  /*    +---------------------+-----------+----------+
+   *    | Thread Group        | Call      | mMailbox |
+   *    |---------------------|-----------+----------+
+   *    | 1. Outside Threads  |   NO      |          |
+   *    | 2. GUI Thread       |  YES      | UNIQUE   |
+   *    +---------------------+-----------+----------+
+   */
+
+  std::vector<closure_type> pending;
+
+  {
+    std::lock_guard lg{mMailbox};
+    if (closed)
+    {
+      return;
+    }
+    std::swap(pending, closures);
+    drainScheduled = false;
+  }
+
+  for (auto &closure: pending)
+  {
+    closure();
+  }
+  application.triggerUpdate();
+}
+
+void CUpdateMailbox::drainFailed()
+{
+  std::lock_guard lg{mMailbox};
+
+  drainScheduled = false;
+}
+
+std::shared_ptr<CUpdateMailbox> CUpdateMailbox::instance(Wt::WApplication &application)
+{
+  std::lock_guard lg{mRegistry};
+
+  if (registry.contains(&application))
+  {
+    return registry.at(&application);
+  }
+  else
+  {
+    auto mailbox = std::make_shared<CUpdateMailbox>(application);
+    registry.emplace(&application, mailbox);
+    application.addChild(std::make_unique<CUpdateMailboxGuard>(&application, mailbox));
+    return mailbox;
+  }
+}
+
+void CUpdateMailbox::post(closure_type closure)
+{
+  /*    +---------------------+-----------+----------+
+   *    | Thread Group        | Call      | mMailbox |
+   *    |---------------------|-----------+----------+
+   *    | 1. Outside Threads  |  YES      | UNIQUE   |
+   *    | 2. GUI Thread       |  YES      |          |
+   *    +---------------------+-----------+----------+
+   */
+
+  if (Wt::WApplication::instance() == &application)
+  {
+    closure();
+    application.triggerUpdate();
+  }
+  else
+  {
+    bool scheduleDrain;
+    std::string sessionID;
+
+    {
+      std::lock_guard lg{mMailbox};
+      if (closed)
+      {
+        return;
+      }
+      closures.push_back(std::move(closure));
+      scheduleDrain = !drainScheduled;
+      drainScheduled = true;
+
+      // The session ID is resolved on each post, as the application may have changed it (changeSessionId()). It is read with the
+      // lock held, so the application cannot be destroyed (close()) while it is read.
+
+      if (scheduleDrain)
+      {
+        sessionID = application.sessionId();
+      }
+    }
+
+    if (scheduleDrain)
+    {
+      // If the session is not found, the fallback clears the schedule. The closures stay queued for the next drain.
+
+      std::shared_ptr<CUpdateMailbox> mailbox = shared_from_this();
+      Wt::WServer::instance()->post(sessionID, [mailbox] { mailbox->drain(); }, [mailbox] { mailbox->drainFailed(); });
+    }
+  }
+}
+
+void CUpdateMailbox::requirePush(bool require)
+{
+  /*    +---------------------+-----------+----------+
+   *    | Thread Group        | Call      | mMailbox |
+   *    |---------------------|-----------+----------+
+   *    | 1. Outside Threads  |   NO      |          |
+   *    | 2. GUI Thread       |  YES      | UNIQUE   |
+   *    +---------------------+-----------+----------+
+   */
+
+  std::lock_guard lg{mMailbox};
+
+  if (closed)
+  {
+    // The application is being destroyed.
+    return;
+  }
+
+  if (require)
+  {
+    if (pushReferences++ == 0)
+    {
+      application.enableUpdates(true);
+    }
+  }
+  else
+  {
+    RUNTIME_ASSERT(pushReferences != 0, "CUpdateMailbox::requirePush: No push reference to release.");
+    if (--pushReferences == 0)
+    {
+      application.enableUpdates(false);
+    }
+  }
+}
@@ -0,0 +1,85 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadDigest.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Computes a set of message digests incrementally.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/uploadDigest.h"
+
+// Miscellaneous library header files
+#include <fmt/format.h>
+#include <GCL>
+
+CUploadDigest::CUploadDigest(std::vector<std::string> const &digestNames)
+{
+  for (auto const &digestName: digestNames)
+  {
+    EVP_MD const *digestType = EVP_get_digestbyname(digestName.c_str());
+    RUNTIME_ASSERT(digestType != nullptr, "CUploadDigest: Unknown digest.");
+
+    EVP_MD_CTX *context = EVP_MD_CTX_new();
+    RUNTIME_ASSERT(context != nullptr && EVP_DigestInit_ex(context, digestType, nullptr) == 1,
+                   "CUploadDigest: Unable to initialise digest.");
+    contexts.emplace_back(digestName, context);
+  }
+}
+
+CUploadDigest::~CUploadDigest()
+{
+  for (auto &[digestName, context]: contexts)
+  {
+    EVP_MD_CTX_free(context);
+  }
+}
+
+CUploadDigest::digests_t CUploadDigest::final()
+{
+  digests_t rv;
+
+  for (auto &[digestName, context]: contexts)
+  {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    std::string hex;
+
+    EVP_DigestFinal_ex(context, digest, &length);
+    for (unsigned int index = 0; index != length; index++)
+    {
+      hex += fmt::format("{:02x}", digest[index]);
+    }
+    rv.emplace(digestName, std::move(hex));
+  }
+  return rv;
+}
+
+void CUploadDigest::update(std::span<char const> data)
+{
+  for (auto &[digestName, context]: contexts)
+  {
+    EVP_DigestUpdate(context, data.data(), data.size());
+  }
+}
@@ -0,0 +1,139 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadGovernor.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Process-wide admission control of uploads against a disk budget.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/uploadGovernor.h"
+
+CUploadGovernor::CUploadGovernor(std::uint64_t tb, std::uint64_t sq) : totalBudget(tb), sessionQuota(sq)
+{
+}
+
+CUploadGovernor::admittedList_t CUploadGovernor::admitQueued()
+{
+  admittedList_t rv;
+  auto iter = queue.begin();
+
+  while (iter != queue.end() && reserved_ + iter->size <= totalBudget)
+  {
+    // Sessions with nothing reserved are not in the map, so the lookup must not insert them.
+
+    auto sessionIter = reservedBySession.find(iter->sessionID);
+    std::uint64_t sessionReserved = (sessionIter != reservedBySession.end()) ? sessionIter->second : 0;
+
+    if (sessionReserved + iter->size > sessionQuota)
+    {
+      // Waiting for the session's own quota.
+
+      iter++;
+    }
+    else
+    {
+      reserved_ += iter->size;
+      reservedBySession[iter->sessionID] = sessionReserved + iter->size;
+      reservations.emplace(iter->ticket, std::make_pair(iter->sessionID, iter->size));
+      rv.emplace_back(iter->ticket, std::move(iter->admitted));
+      iter = queue.erase(iter);
+    }
+  }
+  return rv;
+}
+
+std::size_t CUploadGovernor::queued() const
+{
+  std::lock_guard lg{mGovernor};
+
+  return queue.size();
+}
+
+void CUploadGovernor::release(ticket_t ticket)
+{
+  admittedList_t admitted;
+
+  {
+    std::lock_guard lg{mGovernor};
+
+    if (reservations.contains(ticket))
+    {
+      auto const &[sessionID, size] = reservations.at(ticket);
+      reserved_ -= size;
+      reservedBySession.at(sessionID) -= size;
+      if (reservedBySession.at(sessionID) == 0)
+      {
+        reservedBySession.erase(sessionID);
+      }
+      reservations.erase(ticket);
+    }
+    else
+    {
+      std::erase_if(queue, [ticket](request_t const &request) { return request.ticket == ticket; });
+    }
+    admitted = admitQueued();
+  }
+
+  for (auto &[admittedTicket, admittedFunction]: admitted)
+  {
+    admittedFunction(admittedTicket);
+  }
+}
+
+CUploadGovernor::admission_e CUploadGovernor::request(std::string const &sessionID, std::uint64_t size, ticket_t &ticket,
+                                                      admitted_f admittedFunction)
+{
+  admission_e rv = A_REFUSED;
+  admittedList_t admitted;
+
+  ticket = 0;
+  if (size <= totalBudget && size <= sessionQuota)
+  {
+    // The request joins the queue, so it is admitted in turn with the requests already waiting.
+
+    std::lock_guard lg{mGovernor};
+
+    ticket = ++lastTicket;
+    queue.emplace_back(ticket, sessionID, size, std::move(admittedFunction));
+    admitted = admitQueued();
+    rv = reservations.contains(ticket) ? A_ADMITTED : A_QUEUED;
+  }
+
+  for (auto &[admittedTicket, function]: admitted)
+  {
+    if (admittedTicket != ticket)
+    {
+      function(admittedTicket);
+    }
+  }
+  return rv;
+}
+
+std::uint64_t CUploadGovernor::reserved() const
+{
+  std::lock_guard lg{mGovernor};
+
+  return reserved_;
+}
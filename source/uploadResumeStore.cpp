@@ -0,0 +1,130 @@
+//*********************************************************************************************************************************
+//
+// PROJECT:             Wt Extensions
+// FILE:                uploadResumeStore.cpp
+// LANGUAGE:            C++
+// TARGET OS:           None.
+// NAMESPACE:
+// AUTHOR:              Gavin Blakeman (GGB)
+// LICENSE:             GPLv2
+//
+//                      Copyright 2024 Gavin Blakeman.
+//                      This file is part of the WtExtensions Library (WtExtensions)
+//
+//                      WtExtensions is free software: you can redistribute it and/or modify it under the terms of the GNU General
+//                      Public License as published by the Free Software Foundation, either version 2 of the License, or
+//                      (at your option) any later version.
+//
+//                      WtExtensions is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the
+//                      implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+//                      for more details.
+//
+//                      You should have received a copy of the GNU General Public License along with WtExtensions.  If not,
+//                      see <http://www.gnu.org/licenses/>.
+//
+// OVERVIEW:            Server-side store of partially uploaded files.
+//
+// HISTORY:             2026-10-18 GGB - File Created
+//
+//*********************************************************************************************************************************
+
+#include "include/uploadResumeStore.h"
+
+// Standard C++ library header files
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+
+// Miscellaneous library header files
+#include <fmt/format.h>
+#include <GCL>
+
+CUploadResumeStore::CUploadResumeStore(std::filesystem::path const &d) : directory(d)
+{
+  std::filesystem::create_directories(directory);
+}
+
+void CUploadResumeStore::append(std::filesystem::path const &destination, std::filesystem::path const &source, std::uint64_t bytes)
+{
+  std::ifstream input(source, std::ios::binary);
+  std::ofstream output(destination, std::ios::binary | std::ios::app);
+  RUNTIME_ASSERT(input && output, "CUploadResumeStore: Unable to open file.");
+
+  std::array<char, 65536> buffer;
+  while (bytes != 0 && input)
+  {
+    input.read(buffer.data(), std::min<std::uint64_t>(bytes, buffer.size()));
+    output.write(buffer.data(), input.gcount());
+    bytes -= input.gcount();
+  }
+  RUNTIME_ASSERT(bytes == 0 && output, "CUploadResumeStore: Unable to copy file.");
+}
+
+void CUploadResumeStore::complete(std::string const &key, std::filesystem::path const &spoolFile)
+{
+  std::lock_guard lg{mStore};
+
+  if (entries.contains(key))
+  {
+    entry_t const &entry = entries.at(key);
+    append(entry.partFile, spoolFile, std::filesystem::file_size(spoolFile));
+    std::filesystem::rename(entry.partFile, spoolFile);
+    entries.erase(key);
+  }
+}
+
+void CUploadResumeStore::discard(std::string const &key)
+{
+  std::lock_guard lg{mStore};
+
+  if (entries.contains(key))
+  {
+    std::error_code ec;
+    std::filesystem::remove(entries.at(key).partFile, ec);
+    entries.erase(key);
+  }
+}
+
+std::string CUploadResumeStore::key(std::string const &clientFileName, std::uint64_t size, std::uint64_t lastModified)
+{
+  return fmt::format("{}:{}:{}", clientFileName, size, lastModified);
+}
+
+std::uint64_t CUploadResumeStore::offset(std::string const &key) const
+{
+  std::lock_guard lg{mStore};
+
+  std::uint64_t rv = 0;
+  if (entries.contains(key))
+  {
+    rv = entries.at(key).offset;
+  }
+  return rv;
+}
+
+void CUploadResumeStore::save(std::string const &key, std::filesystem::path const &spoolFile, std::uint64_t chunkSize)
+{
+  std::error_code ec;
+  std::uint64_t bytes = std::filesystem::file_size(spoolFile, ec);
+
+  if (!ec && chunkSize != 0)
+  {
+    // A partly received chunk cannot be resumed. Only whole chunks are kept.
+
+    bytes -= bytes % chunkSize;
+    if (bytes != 0)
+    {
+      std::lock_guard lg{mStore};
+
+      entry_t &entry = entries[key];
+      if (entry.partFile.empty())
+      {
+        entry.partFile = directory / fmt::format("{:016x}.part", std::hash<std::string>{}(key));
+        std::filesystem::remove(entry.partFile, ec);
+      }
+      append(entry.partFile, spoolFile, bytes);
+      entry.offset += bytes;
+    }
+  }
+}